@@ -0,0 +1,162 @@
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+#include "seminal.h"
+
+// Runs the seminal input analysis on bitcode files without compiling them.
+// Bitcode is loaded lazily and analyzed one function at a time (see
+// seminal::analyzeModule); several files are analyzed in parallel with -j.
+// All the -seminal-* options of the pass are accepted.
+
+using namespace llvm;
+
+static cl::list<std::string> Inputs(cl::Positional, cl::desc("<.bc/.ll files or directories>"));
+
+static cl::opt<std::string> InputList("input-list",
+    cl::desc("File listing one input per line"), cl::value_desc("filename"), cl::init(""));
+
+static cl::opt<std::string> OutputDir("output-dir",
+    cl::desc("Write one report per input to this directory instead of all reports to stdout"),
+    cl::value_desc("directory"), cl::init(""));
+
+static cl::opt<bool> WholeModule("whole-module",
+    cl::desc("Load each input entirely, so globals are followed across functions as by the plugin"),
+    cl::init(false));
+
+static cl::opt<unsigned> Jobs("j",
+    cl::desc("Number of inputs analyzed in parallel (0 = all cores)"), cl::init(1));
+
+static bool isIRFile(StringRef path) {
+    StringRef ext = sys::path::extension(path);
+    return ext == ".bc" || ext == ".ll";
+}
+
+// The inputs given, with directories searched recursively for .bc and .ll
+// files in name order
+static bool collectInputs(std::vector<std::string> &files) {
+    std::vector<std::string> paths(Inputs.begin(), Inputs.end());
+    if (!InputList.empty()) {
+        ErrorOr<std::unique_ptr<MemoryBuffer>> list = MemoryBuffer::getFile(InputList);
+        if (!list) {
+            errs() << "error: cannot read input list '" << InputList << "': " << list.getError().message() << "\n";
+            return false;
+        }
+        for (line_iterator It(**list, /*SkipBlanks=*/true); !It.is_at_eof(); ++It) {
+            paths.push_back(It->trim().str());
+        }
+    }
+
+    for (const std::string &path : paths) {
+        if (!sys::fs::is_directory(path)) {
+            files.push_back(path);
+            continue;
+        }
+        std::vector<std::string> found;
+        std::error_code EC;
+        for (sys::fs::recursive_directory_iterator It(path, EC), End; It != End && !EC; It.increment(EC)) {
+            if (isIRFile(It->path()) && !sys::fs::is_directory(It->path())) {
+                found.push_back(It->path());
+            }
+        }
+        if (EC) {
+            errs() << "error: cannot read directory '" << path << "': " << EC.message() << "\n";
+            return false;
+        }
+        llvm::sort(found);
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    return true;
+}
+
+// Analyze one input with its own context, so inputs can be analyzed on
+// different threads. The report is returned, or written to -output-dir.
+static bool analyzeFile(const std::string &path, std::string &report) {
+    LLVMContext Context;
+    SMDiagnostic Err;
+    std::unique_ptr<Module> M = getLazyIRFileModule(path, Err, Context);
+    if (!M) {
+        raw_string_ostream OS(report);
+        Err.print("seminal-analyze", OS);
+        return false;
+    }
+
+    raw_string_ostream OS(report);
+    bool ok = seminal::analyzeModule(*M, OS, WholeModule);
+    OS.flush();
+    if (!ok || OutputDir.empty()) {
+        return ok;
+    }
+
+    // Named like the link summaries, after the input and a hash of its path
+    SmallString<128> out(OutputDir);
+    sys::path::append(out, sys::path::stem(path) + "-" + utohexstr(xxHash64(path)) + ".report");
+    std::error_code EC;
+    raw_fd_ostream file(out, EC, sys::fs::OF_None);
+    if (EC) {
+        report = "error: cannot open report '" + std::string(out) + "': " + EC.message() + "\n";
+        return false;
+    }
+    file << report;
+    report.clear();
+    return true;
+}
+
+int main(int argc, char **argv) {
+    InitLLVM X(argc, argv);
+    cl::ParseCommandLineOptions(argc, argv, "seminal input analysis of bitcode files\n");
+
+    std::vector<std::string> files;
+    if (!collectInputs(files)) {
+        return 1;
+    }
+    if (files.empty()) {
+        errs() << "error: no input files\n";
+        return 1;
+    }
+    if (OutputDir.empty() && seminal::isBinaryReport()) {
+        errs() << "error: -seminal-report-format=binary needs -output-dir\n";
+        return 1;
+    }
+    if (!OutputDir.empty()) {
+        if (std::error_code EC = sys::fs::create_directories(OutputDir)) {
+            errs() << "error: cannot create output directory: " << EC.message() << "\n";
+            return 1;
+        }
+    }
+
+    // Reports are printed in input order, whatever order the inputs finish in
+    std::vector<std::string> reports(files.size());
+    std::vector<char> ok(files.size());
+    ThreadPool pool(hardware_concurrency(Jobs));
+    for (size_t i = 0; i < files.size(); i++) {
+        pool.async([&, i] { ok[i] = analyzeFile(files[i], reports[i]); });
+    }
+    pool.wait();
+
+    int status = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (ok[i]) {
+            outs() << reports[i];
+        } else {
+            errs() << reports[i];
+            status = 1;
+        }
+    }
+    return status;
+}
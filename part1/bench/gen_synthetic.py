@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+# Generate a synthetic LLVM IR module for benchmarking the seminal input pass.
+#
+# Every function reads `fanout` locals with scanf, then has `branches`
+# conditional branches. Each branch condition is the end of a chain of
+# `depth` instructions, and every step of the chain reads one of the locals
+# again, so the trace of a branch visits about depth * fanout values.
+# Function i calls function i - 1, so the call graph is a chain as well.
+
+import argparse
+import sys
+
+
+def gen_function(out, index, branches, depth, fanout):
+    out.append(f"define i32 @f{index}(i32 %arg) {{")
+    out.append("entry:")
+    for j in range(fanout):
+        out.append(f"  %x{j} = alloca i32, align 4")
+    for j in range(fanout):
+        out.append(f"  %s{j} = call i32 (i8*, ...) @__isoc99_scanf(i8* getelementptr inbounds "
+                   f"([3 x i8], [3 x i8]* @.fmt, i64 0, i64 0), i32* %x{j})")
+    if index > 0:
+        out.append(f"  %prev = call i32 @f{index - 1}(i32 %arg)")
+        seed = "%prev"
+    else:
+        seed = "%arg"
+    out.append("  br label %b0")
+
+    for b in range(branches):
+        out.append(f"b{b}:")
+        prev = seed
+        for d in range(depth):
+            slot = (b + d) % fanout
+            out.append(f"  %l{b}.{d} = load i32, i32* %x{slot}, align 4")
+            out.append(f"  %c{b}.{d} = add i32 {prev}, %l{b}.{d}")
+            prev = f"%c{b}.{d}"
+        out.append(f"  %cmp{b} = icmp sgt i32 {prev}, {b}")
+        out.append(f"  br i1 %cmp{b}, label %t{b}, label %b{b + 1}")
+        out.append(f"t{b}:")
+        out.append(f"  store i32 {prev}, i32* %x{b % fanout}, align 4")
+        out.append(f"  br label %b{b + 1}")
+
+    out.append(f"b{branches}:")
+    out.append(f"  %r = load i32, i32* %x0, align 4")
+    out.append("  ret i32 %r")
+    out.append("}")
+    out.append("")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--functions", type=int, default=10, help="number of functions")
+    parser.add_argument("--branches", type=int, default=10, help="conditional branches per function")
+    parser.add_argument("--depth", type=int, default=10, help="instructions between a scanf and a branch")
+    parser.add_argument("--fanout", type=int, default=2, help="scanf'd locals per function")
+    parser.add_argument("-o", "--output", default="-", help="output .ll file")
+    args = parser.parse_args()
+    if min(args.functions, args.branches, args.depth, args.fanout) < 1:
+        parser.error("all sizes must be at least 1")
+
+    out = [
+        f"; functions={args.functions} branches={args.branches} depth={args.depth} fanout={args.fanout}",
+        '@.fmt = private unnamed_addr constant [3 x i8] c"%d\\00", align 1',
+        "",
+        "declare i32 @__isoc99_scanf(i8*, ...)",
+        "",
+    ]
+    for i in range(args.functions):
+        gen_function(out, i, args.branches, args.depth, args.fanout)
+
+    text = "\n".join(out)
+    if args.output == "-":
+        sys.stdout.write(text)
+    else:
+        with open(args.output, "w") as f:
+            f.write(text)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,258 @@
+#!/usr/bin/env python3
+# Benchmark the seminal input pass on synthetic modules, on the sample
+# modules in samples/ and on the test programs of the repository.
+#
+# Each input is run through opt -passes=seminal-trace with
+# -seminal-phase-stats, plus the options a sample names on its first line. The minimum time
+# over --repeat runs is reported per phase, plus the number of values traced
+# and the peak memory of the opt process. Results can be saved with --save
+# and compared against an earlier run with --baseline, which fails when a
+# phase got slower, used more memory, or traced more values than allowed by
+# --tolerance.
+#
+# The findings can be checked as well: with --golden-dir the summary report
+# of each input, with the source directory stripped from its paths, is
+# compared against <golden-dir>/<input>.summary, which --update-golden
+# writes. The test programs are also compiled with the plugin loaded into
+# clang, as the readme shows, and that report must match the golden one too.
+# --budgets gives every input an absolute limit on the total time of its
+# phases and on peak memory.
+
+import argparse
+import glob
+import json
+import difflib
+import os
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# name: (functions, branches, depth, fanout)
+PRESETS = {
+    "small": [
+        ("syn-f10-b10-d10-w2", 10, 10, 10, 2),
+    ],
+    "medium": [
+        ("syn-f10-b10-d10-w2", 10, 10, 10, 2),
+        ("syn-f100-b20-d20-w4", 100, 20, 20, 4),
+        ("syn-f10-b10-d500-w2", 10, 10, 500, 2),
+        ("syn-f10-b50-d10-w32", 10, 50, 10, 32),
+    ],
+    "large": [
+        ("syn-f100-b20-d20-w4", 100, 20, 20, 4),
+        ("syn-f1000-b20-d20-w4", 1000, 20, 20, 4),
+        ("syn-f10-b10-d5000-w2", 10, 10, 5000, 2),
+        ("syn-f10-b200-d20-w128", 10, 200, 20, 128),
+    ],
+}
+
+
+def generate_inputs(args):
+    inputs = []
+    for name, functions, branches, depth, fanout in PRESETS[args.preset]:
+        path = os.path.join(args.work_dir, name + ".ll")
+        if not os.path.exists(path):
+            subprocess.check_call([sys.executable, os.path.join(HERE, "gen_synthetic.py"),
+                                   "--functions", str(functions), "--branches", str(branches),
+                                   "--depth", str(depth), "--fanout", str(fanout), "-o", path])
+        inputs.append((name, path, None))
+
+    for path in sorted(glob.glob(os.path.join(HERE, "samples", "*.ll"))):
+        inputs.append((os.path.splitext(os.path.basename(path))[0], path, None))
+
+    if not args.clang:
+        print("note: no clang given, skipping the test programs and their golden reports", file=sys.stderr)
+        return inputs
+    source_dir = os.path.abspath(args.source_dir)
+    sources = glob.glob(os.path.join(source_dir, "test*.c")) + glob.glob(os.path.join(source_dir, "ex*.c"))
+    for source in sorted(sources):
+        name = os.path.splitext(os.path.basename(source))[0]
+        path = os.path.join(args.work_dir, name + ".ll")
+        subprocess.check_call([args.clang, "-O0", "-g", "-fno-discard-value-names",
+                               "-S", "-emit-llvm", source, "-o", path])
+        inputs.append((name, path, source))
+    return inputs
+
+
+# Options of the pass a sample module needs, from a first line like
+# "; seminal-args: -seminal-ssa"
+def input_args(path):
+    with open(path) as f:
+        first = f.readline()
+    prefix = "; seminal-args:"
+    return first[len(prefix):].split() if first.startswith(prefix) else []
+
+
+# Run opt once, returning the phase statistics and the peak RSS of opt in KB
+def run_once(args, path):
+    command = [args.opt, "-load", args.plugin, "-load-pass-plugin", args.plugin,
+               "-passes=seminal-trace", "-disable-output", "-seminal-phase-stats",
+               "-seminal-report-file=" + os.devnull] + args.pass_args + input_args(path) + [path]
+    proc = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE,
+                            universal_newlines=True)
+    stderr = proc.stderr.read()
+    _, status, usage = os.wait4(proc.pid, 0)
+    if status != 0:
+        sys.exit(f"error: {' '.join(command)} failed:\n{stderr}")
+
+    phases = {}
+    for line in stderr.splitlines():
+        if line.startswith('{"module"'):
+            record = json.loads(line)
+            phases[record["phase"]] = record
+    return phases, usage.ru_maxrss
+
+
+# The summary report of an input, without the source directory in its paths
+def run_report(args, path):
+    command = [args.opt, "-load", args.plugin, "-load-pass-plugin", args.plugin,
+               "-passes=seminal-trace", "-disable-output", "-seminal-report-format=summary"] + args.pass_args + input_args(path) + [path]
+    proc = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, universal_newlines=True)
+    if proc.returncode != 0:
+        sys.exit(f"error: {' '.join(command)} failed:\n{proc.stderr}")
+    return proc.stderr.replace(os.path.abspath(args.source_dir) + os.sep, "")
+
+
+# The summary report of a test program compiled by clang with the plugin,
+# loaded with -Xclang -load so that the -mllvm options are known
+def run_clang_report(args, source):
+    report = os.path.join(args.work_dir, os.path.basename(source) + ".summary")
+    mllvm = ["-seminal-ep=auto", "-seminal-report-format=summary", "-seminal-report-file=" + report] + args.pass_args
+    command = [args.clang, "-O0", "-g", "-fno-discard-value-names", "-Xclang", "-load", "-Xclang", args.plugin,
+               "-fpass-plugin=" + args.plugin] + [arg for option in mllvm for arg in ("-mllvm", option)] + \
+              ["-c", source, "-o", os.devnull]
+    proc = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, universal_newlines=True)
+    if proc.returncode != 0 or not os.path.exists(report):
+        sys.exit(f"error: {' '.join(command)} failed:\n{proc.stderr}")
+    with open(report) as f:
+        return f.read().replace(os.path.abspath(args.source_dir) + os.sep, "")
+
+
+def check_golden(args, name, report, label=None):
+    label = label or name
+    golden = os.path.join(args.golden_dir, name + ".summary")
+    if args.update_golden:
+        os.makedirs(args.golden_dir, exist_ok=True)
+        with open(golden, "w") as f:
+            f.write(report)
+        return []
+    if not os.path.exists(golden):
+        return [f"{label}: no golden report {golden}, create it with --update-golden"]
+    with open(golden) as f:
+        expected = f.read()
+    if report == expected:
+        return []
+    diff = list(difflib.unified_diff(expected.splitlines(True), report.splitlines(True), golden, label))
+    if len(diff) > 40:
+        diff = diff[:40] + [f"... {len(diff) - 40} more lines\n"]
+    return [f"{label}: report differs from {golden}\n" + "".join(diff)]
+
+
+# Budgets are a JSON object of input names to {"seconds": ..., "peak_rss_kb": ...};
+# the entry "*" applies to inputs without their own
+def check_budgets(results, budgets):
+    failures = []
+    for name, result in results.items():
+        budget = budgets.get(name, budgets.get("*"))
+        if not budget:
+            continue
+        seconds = sum(stats["seconds"] for stats in result["phases"].values())
+        if "seconds" in budget and seconds > budget["seconds"]:
+            failures.append(f"{name}: {seconds:.4f} s over the budget of {budget['seconds']} s")
+        if "peak_rss_kb" in budget and result["peak_rss_kb"] > budget["peak_rss_kb"]:
+            failures.append(f"{name}: peak RSS {result['peak_rss_kb']} KB over the budget of "
+                            f"{budget['peak_rss_kb']} KB")
+    return failures
+
+
+def measure(args, path):
+    result = {"phases": {}, "peak_rss_kb": 0}
+    for _ in range(args.repeat):
+        phases, rss = run_once(args, path)
+        result["peak_rss_kb"] = max(result["peak_rss_kb"], rss)
+        for name, record in phases.items():
+            best = result["phases"].setdefault(name, {"seconds": record["seconds"],
+                                                      "visited_values": record["visited_values"]})
+            best["seconds"] = min(best["seconds"], record["seconds"])
+    return result
+
+
+def compare(results, baseline, tolerance):
+    failures = []
+    for name, result in results.items():
+        old = baseline.get(name)
+        if not old:
+            continue
+        limit = 1 + tolerance
+        if result["peak_rss_kb"] > old["peak_rss_kb"] * limit:
+            failures.append(f"{name}: peak RSS {old['peak_rss_kb']} -> {result['peak_rss_kb']} KB")
+        for phase, stats in result["phases"].items():
+            before = old["phases"].get(phase)
+            if not before:
+                continue
+            # Ignore sub-millisecond phases, their timing is mostly noise
+            if stats["seconds"] > before["seconds"] * limit and stats["seconds"] > 0.001:
+                failures.append(f"{name}/{phase}: {before['seconds']:.4f} -> {stats['seconds']:.4f} s")
+            if stats["visited_values"] > before["visited_values"] * limit:
+                failures.append(f"{name}/{phase}: visited values "
+                                f"{before['visited_values']} -> {stats['visited_values']}")
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--opt", default="opt", help="opt binary")
+    parser.add_argument("--plugin", required=True, help="path to part1pass.so")
+    parser.add_argument("--clang", default="", help="clang binary used to compile the test programs")
+    parser.add_argument("--source-dir", default=os.path.dirname(os.path.dirname(HERE)),
+                        help="directory with the test*.c and ex*.c programs")
+    parser.add_argument("--work-dir", default="bench-work", help="directory for the generated IR")
+    parser.add_argument("--preset", choices=sorted(PRESETS), default="medium",
+                        help="set of synthetic modules to run")
+    parser.add_argument("--repeat", type=int, default=3, help="runs per input, the fastest is kept")
+    parser.add_argument("--pass-arg", dest="pass_args", action="append", default=[],
+                        help="extra option for the pass, e.g. --pass-arg=-seminal-interprocedural")
+    parser.add_argument("--save", help="write the results to this JSON file")
+    parser.add_argument("--baseline", help="compare against results saved with --save")
+    parser.add_argument("--tolerance", type=float, default=0.2,
+                        help="allowed relative regression against the baseline")
+    parser.add_argument("--golden-dir", help="compare the summary report of each input against this directory")
+    parser.add_argument("--update-golden", action="store_true", help="write the golden reports instead")
+    parser.add_argument("--budgets", help="JSON file of time and memory budgets per input")
+    args = parser.parse_args()
+    if args.update_golden and not args.golden_dir:
+        parser.error("--update-golden needs --golden-dir")
+
+    os.makedirs(args.work_dir, exist_ok=True)
+    results = {}
+    failures = []
+    print(f"{'input':<36} {'phase':<10} {'seconds':>10} {'values':>10} {'peak RSS KB':>12}")
+    for name, path, source in generate_inputs(args):
+        result = measure(args, path)
+        results[name] = result
+        for phase, stats in result["phases"].items():
+            print(f"{name:<36} {phase:<10} {stats['seconds']:>10.4f} {stats['visited_values']:>10} "
+                  f"{result['peak_rss_kb']:>12}")
+        if args.golden_dir:
+            failures += check_golden(args, name, run_report(args, path))
+            if source and not args.update_golden:
+                failures += check_golden(args, name, run_clang_report(args, source), name + " in clang")
+
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+    if args.baseline:
+        with open(args.baseline) as f:
+            failures += compare(results, json.load(f), args.tolerance)
+    if args.budgets:
+        with open(args.budgets) as f:
+            failures += check_budgets(results, json.load(f))
+    for failure in failures:
+        print("regression: " + failure, file=sys.stderr)
+    if failures:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,41 @@
+; seminal-args: -seminal-interprocedural
+; leaf branches on its argument and returns a value read by scanf. The
+; argument only receives the constant main passes through mid, so the
+; branch reaches no seminal input; the scanf only reaches the return value.
+@.fmt = private unnamed_addr constant [3 x i8] c"%d\00", align 1
+
+declare i32 @__isoc99_scanf(i8*, ...)
+
+define i32 @leaf(i32 %x) {
+entry:
+  %v = alloca i32, align 4
+  %cmp = icmp sgt i32 %x, 0
+  br i1 %cmp, label %read, label %done
+
+read:
+  %s = call i32 (i8*, ...) @__isoc99_scanf(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @.fmt, i64 0, i64 0), i32* %v)
+  %r = load i32, i32* %v, align 4
+  ret i32 %r
+
+done:
+  ret i32 0
+}
+
+define i32 @mid(i32 %y) {
+entry:
+  %r = call i32 @leaf(i32 %y)
+  ret i32 %r
+}
+
+define i32 @main() {
+entry:
+  %r = call i32 @mid(i32 7)
+  %cmp = icmp eq i32 %r, 1
+  br i1 %cmp, label %one, label %other
+
+one:
+  ret i32 1
+
+other:
+  ret i32 0
+}
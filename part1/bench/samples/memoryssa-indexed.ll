@@ -0,0 +1,34 @@
+; seminal-args: -seminal-memoryssa
+; A load from a local table at an index read by scanf. The stores into the
+; table are constants, so with MemorySSA the input is only found through
+; the address of the load.
+@.fmt = private unnamed_addr constant [3 x i8] c"%d\00", align 1
+
+declare i32 @__isoc99_scanf(i8*, ...)
+
+define i32 @lookup() {
+entry:
+  %tab = alloca [4 x i32], align 16
+  %n.addr = alloca i32, align 4
+  %t0 = getelementptr inbounds [4 x i32], [4 x i32]* %tab, i64 0, i64 0
+  store i32 1, i32* %t0, align 16
+  %t1 = getelementptr inbounds [4 x i32], [4 x i32]* %tab, i64 0, i64 1
+  store i32 0, i32* %t1, align 4
+  %t2 = getelementptr inbounds [4 x i32], [4 x i32]* %tab, i64 0, i64 2
+  store i32 1, i32* %t2, align 8
+  %t3 = getelementptr inbounds [4 x i32], [4 x i32]* %tab, i64 0, i64 3
+  store i32 0, i32* %t3, align 4
+  %s = call i32 (i8*, ...) @__isoc99_scanf(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @.fmt, i64 0, i64 0), i32* %n.addr)
+  %n = load i32, i32* %n.addr, align 4
+  %idx = sext i32 %n to i64
+  %p = getelementptr inbounds [4 x i32], [4 x i32]* %tab, i64 0, i64 %idx
+  %v = load i32, i32* %p, align 4
+  %cmp = icmp ne i32 %v, 0
+  br i1 %cmp, label %yes, label %no
+
+yes:
+  ret i32 1
+
+no:
+  ret i32 0
+}
@@ -0,0 +1,33 @@
+; seminal-args: -seminal-ssa
+; A value read by scanf through an out-parameter, as test4 and test5 look
+; at -O2: in SSA mode the pointer argument must still be followed to the
+; scanf writing through it.
+@.fmt = private unnamed_addr constant [3 x i8] c"%d\00", align 1
+
+declare i32 @__isoc99_scanf(i8*, ...)
+
+define i32 @read_choice(i32* %p) {
+entry:
+  %s = call i32 (i8*, ...) @__isoc99_scanf(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @.fmt, i64 0, i64 0), i32* %p)
+  %v = load i32, i32* %p, align 4
+  %cmp = icmp eq i32 %v, 3
+  br i1 %cmp, label %quit, label %stay
+
+quit:
+  ret i32 0
+
+stay:
+  ret i32 %v
+}
+
+define i32 @count(i32 %n) {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %pos, label %neg
+
+pos:
+  ret i32 %n
+
+neg:
+  ret i32 0
+}
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# Connect seminal inputs across translation units from the link summaries
+# written with -seminal-summary-dir.
+#
+# Within a module, a call to a function defined in another module is traced
+# like a seminal input. The summary of each module lists its branches with
+# the seminal inputs and external calls reaching them, and the functions it
+# exports with what a call to them yields. Here every external call is
+# replaced by the seminal inputs of its definition, following external calls
+# of the definition in turn, and the branches are written out in the jsonl or
+# csv report formats of the pass. No IR is needed, only the summaries.
+
+import argparse
+import csv
+import glob
+import json
+import os
+import struct
+import sys
+
+MAGIC = 0x32534D53  # "SMS2"
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def u32(self):
+        (value,) = struct.unpack_from("<I", self.data, self.offset)
+        self.offset += 4
+        return value
+
+    def string(self):
+        size = self.u32()
+        if self.offset + size > len(self.data):
+            raise ValueError("string past the end of the file")
+        value = self.data[self.offset:self.offset + size].decode("utf-8", "replace")
+        self.offset += size
+        return value
+
+    def location(self):
+        return self.string(), self.u32(), self.u32()
+
+    # Seminal inputs as (callee, function, file, line, column), then the
+    # names of the external callees
+    def sources(self):
+        sources = []
+        for _ in range(self.u32()):
+            callee = self.string()
+            function = self.string()
+            sources.append((callee, function) + self.location())
+        external = [self.string() for _ in range(self.u32())]
+        return sources, external
+
+
+def read_summary(path, branches, functions):
+    with open(path, "rb") as f:
+        reader = Reader(f.read())
+    if reader.u32() != MAGIC:
+        raise ValueError("not a seminal link summary")
+    module = reader.string()
+    for _ in range(reader.u32()):
+        function = reader.string()
+        location = reader.location()
+        kind = reader.string()
+        truncated = bool(reader.u32())
+        sources, external = reader.sources()
+        branches.append((module, function, location, kind, truncated, sources, external))
+    for _ in range(reader.u32()):
+        name = reader.string()
+        sources, external = reader.sources()
+        # Inline functions can be defined in several modules
+        entry = functions.setdefault(name, ([], []))
+        entry[0].extend(s for s in sources if s not in entry[0])
+        entry[1].extend(e for e in external if e not in entry[1])
+
+
+# The seminal inputs a call to each function yields, through any number of
+# external calls. Recursion across modules is handled by iterating until
+# nothing changes.
+def resolve(functions):
+    resolved = {name: list(sources) for name, (sources, _) in functions.items()}
+    changed = True
+    while changed:
+        changed = False
+        for name, (_, external) in functions.items():
+            own = resolved[name]
+            for callee in external:
+                for source in resolved.get(callee, ()):
+                    if source not in own:
+                        own.append(source)
+                        changed = True
+    return resolved
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("summaries", nargs="+",
+                        help="link summaries, or directories given to -seminal-summary-dir")
+    parser.add_argument("--format", choices=["jsonl", "csv"], default="jsonl", help="report format")
+    parser.add_argument("-o", "--output", default="-", help="report file")
+    args = parser.parse_args()
+
+    paths = []
+    for path in args.summaries:
+        paths.extend(sorted(glob.glob(os.path.join(path, "*.sms"))) if os.path.isdir(path) else [path])
+
+    branches = []
+    functions = {}
+    for path in paths:
+        try:
+            read_summary(path, branches, functions)
+        except (OSError, ValueError, struct.error) as error:
+            sys.exit(f"error: {path}: {error}")
+    resolved = resolve(functions)
+
+    out = sys.stdout if args.output == "-" else open(args.output, "w", newline="")
+    if args.format == "csv":
+        writer = csv.writer(out, lineterminator="\n")
+        writer.writerow(["branch_id", "function", "file", "line", "column", "source_callee", "source_function",
+                         "source_file", "source_line", "source_column", "truncated", "kind"])
+    for id, (module, function, (file, line, column), kind, truncated, sources, external) in enumerate(branches):
+        sources = list(sources)
+        for callee in external:
+            sources.extend(s for s in resolved.get(callee, ()) if s not in sources)
+
+        if args.format == "csv":
+            for source in sources or [("", "", "", "", "")]:
+                writer.writerow([id, function, file, line, column] + list(source) + [int(truncated), kind])
+            continue
+        json.dump({"id": id, "function": function, "file": file, "line": line, "column": column,
+                   "kind": kind, "truncated": truncated,
+                   "sources": [{"callee": callee, "function": source_function, "file": source_file,
+                                "line": source_line, "column": source_column}
+                               for callee, source_function, source_file, source_line, source_column in sources]},
+                  out, separators=(",", ":"))
+        out.write("\n")
+
+
+if __name__ == "__main__":
+    main()
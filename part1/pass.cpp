@@ -1,255 +1,3481 @@
 #include <stdio.h>
 #include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <chrono>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
 #include <vector>
-#include <unordered_set>
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/ADT/Twine.h"
 
 #include "llvm/Pass.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/PassPlugin.h"
 
+#include "llvm/Analysis/CallGraph.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/ADT/SCCIterator.h"
+
 #include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/DebugInfoMetadata.h"
 
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 
+#include "llvm/Transforms/Utils/ModuleUtils.h"
+
+#include "seminal.h"
+#include "seminal_analysis.h"
+#include "seminal_report.h"
 
 using namespace llvm;
+using seminal::BranchFinding;
+using seminal::SeminalInputAnalysis;
+using seminal::SeminalInputInfo;
+
+#define DEBUG_TYPE "seminal"
+
+STATISTIC(NumBranchesTraced, "Number of conditional branches traced");
+STATISTIC(NumValuesTraced, "Number of values visited by the trace");
+STATISTIC(NumSummaryHits, "Number of visits answered by a memoized summary");
+STATISTIC(NumCycleSkips, "Number of visits skipped because the value is being traced");
+STATISTIC(NumSeminalInputs, "Number of seminal input calls found");
+STATISTIC(NumFunctionSummaryUses, "Number of calls and arguments resolved by an interprocedural summary");
+STATISTIC(NumGlobalSummaryUses, "Number of global variables resolved by a module-level summary");
+STATISTIC(NumCycleComponents, "Number of def-use cycles collapsed into one node");
+STATISTIC(NumCachedFunctions, "Number of functions whose findings were replayed from the cache");
 
 namespace {
 
-struct SkeletonPass : public PassInfoMixin<SkeletonPass> {
+static cl::opt<bool> ParallelAnalysis("seminal-parallel",
+    cl::desc("Trace the branches of each function in parallel"), cl::init(false));
 
+static cl::opt<unsigned> AnalysisThreads("seminal-threads",
+    cl::desc("Number of threads used by -seminal-parallel (0 = all cores)"), cl::init(0));
 
-    // Helper function to find the source location of an instruction
-    void printInstrDebugLocation(Instruction *I){
-        // Retrieve and print source location (if available)
-        if (DebugLoc debugLoc = I->getDebugLoc()) {
-            unsigned line = debugLoc.getLine();
-            unsigned col = debugLoc.getCol();
-            auto *scope = debugLoc->getScope();
-            StringRef file = scope->getFilename();
-            StringRef dir = scope->getDirectory();
+enum class ReportFormat { Text, JSONLines, CSV, Summary, Binary };
 
-            errs() << "\tSource Location: " << dir << "/" << file << ":" << line << ":" << col << "\n";
-        } else {
-            errs() << "\tNo debug location available for this instruction.\n";
+static cl::opt<ReportFormat> ReportFormatOpt("seminal-report-format",
+    cl::desc("Format of the seminal input report"),
+    cl::values(clEnumValN(ReportFormat::Text, "text", "Human readable trace (default)"),
+               clEnumValN(ReportFormat::JSONLines, "jsonl", "One JSON object per branch"),
+               clEnumValN(ReportFormat::CSV, "csv", "One row per branch and seminal input"),
+               clEnumValN(ReportFormat::Summary, "summary",
+                          "Each seminal input with the branches it reaches, and each branch with its inputs"),
+               clEnumValN(ReportFormat::Binary, "binary", "Binary tables, see seminal_report.h")),
+    cl::init(ReportFormat::Text));
+
+static cl::opt<std::string> ReportFile("seminal-report-file",
+    cl::desc("Write the seminal input report to this file instead of stderr"),
+    cl::value_desc("filename"), cl::init(""));
+
+// Source location of an instruction in the structured report formats
+struct SourceLocation {
+    std::string file;
+    unsigned line = 0;
+    unsigned col = 0;
+};
+
+static SourceLocation getSourceLocation(const Instruction *I) {
+    SourceLocation Loc;
+    if (DebugLoc debugLoc = I->getDebugLoc()) {
+        auto *scope = debugLoc->getScope();
+        SmallString<128> path(scope->getFilename());
+        if (!sys::path::is_absolute(path)) {
+            path = scope->getDirectory();
+            sys::path::append(path, scope->getFilename());
         }
+        Loc.file = std::string(path);
+        Loc.line = debugLoc.getLine();
+        Loc.col = debugLoc.getCol();
     }
+    return Loc;
+}
 
-    void printValueSourceLocation(Value *V) {
-        User* lastUser = nullptr;
-        for (auto *user : V->users()) {
-            lastUser = user;
-        }
+static StringRef getCalleeName(const CallInst *CI) {
+    if (const Function *callee = CI->getCalledFunction()) {
+        return callee->getName();
+    }
+    return "";
+}
 
-        if (auto *instr = llvm::dyn_cast<llvm::Instruction>(lastUser)) {
-            if (llvm::DebugLoc debugLoc = instr->getDebugLoc()) {
-                unsigned line = debugLoc.getLine();
-                unsigned col = debugLoc.getCol();
-                llvm::StringRef file = debugLoc->getScope()->getFilename();
-                llvm::StringRef dir = debugLoc->getScope()->getDirectory();
-                llvm::errs() << "\tLocation: " << dir << "/" << file << ":" << line << ":" << col << "\n";
-            }
-        }
+enum class ControlFlowKind { Switch, Select, IndirectBr };
+
+static cl::bits<ControlFlowKind> ControlFlowKinds("seminal-control-flow",
+    cl::desc("Also trace these instructions besides conditional branches"),
+    cl::values(clEnumValN(ControlFlowKind::Switch, "switch", "switch conditions"),
+               clEnumValN(ControlFlowKind::Select, "select", "select conditions"),
+               clEnumValN(ControlFlowKind::IndirectBr, "indirectbr", "indirect branch addresses")),
+    cl::CommaSeparated);
+
+// The value an instruction the pass traces decides the control flow on: the
+// condition of a conditional branch, and with -seminal-control-flow the
+// condition of a switch or select or the address of an indirect branch.
+// Null for other instructions.
+static Value *getDecidingValue(Instruction &I) {
+    if (auto *br = dyn_cast<BranchInst>(&I)) {
+        return br->isConditional() ? br->getCondition() : nullptr;
+    }
+    if (auto *SI = dyn_cast<SwitchInst>(&I)) {
+        return ControlFlowKinds.isSet(ControlFlowKind::Switch) ? SI->getCondition() : nullptr;
+    }
+    if (auto *select = dyn_cast<SelectInst>(&I)) {
+        return ControlFlowKinds.isSet(ControlFlowKind::Select) ? select->getCondition() : nullptr;
+    }
+    if (auto *IBI = dyn_cast<IndirectBrInst>(&I)) {
+        return ControlFlowKinds.isSet(ControlFlowKind::IndirectBr) ? IBI->getAddress() : nullptr;
     }
+    return nullptr;
+}
 
-    // Helper function to find the variable name associated with an instruction
-    void printValueName(Value *V) {
-        errs() << "\tValue has name: " << V->hasName() << ", value name: " << V->getName() << "\n";
+// Kind of a traced instruction in the reports
+static StringRef getControlFlowKind(const Instruction *I) {
+    if (isa<SwitchInst>(I)) {
+        return "switch";
+    }
+    if (isa<SelectInst>(I)) {
+        return "select";
     }
+    if (isa<IndirectBrInst>(I)) {
+        return "indirectbr";
+    }
+    return "branch";
+}
+
+// A seminal input call site and a branch it reaches, detached from the IR so
+// that they can be written out later or cached across builds
+struct SourceRecord {
+    std::string callee;
+    std::string function;
+    SourceLocation loc;
+    std::vector<int> arguments;  // with -seminal-fuzz-dir, see addFuzzInfo
+};
 
-    std::vector<Instruction*> checked_seminal_inputs;
+struct BranchRecord {
+    std::string function;
+    SourceLocation loc;
+    std::string kind = "branch";  // see getControlFlowKind
+    std::vector<SourceRecord> sources;
+    bool truncated = false;
+    std::vector<std::string> externalCalls;  // names of the external callees
+    std::optional<unsigned> id;  // with a query, the id of the branch in a full report
+    std::vector<std::string> tokens;  // with -seminal-fuzz-dir, see addFuzzInfo
+};
 
-    void checkSeminalInput(Value *V) {
+static SourceRecord makeSourceRecord(const CallInst *source) {
+    return {getCalleeName(source).str(), source->getFunction()->getName().str(), getSourceLocation(source)};
+}
 
-        // errs() << "\t\tcheckSeminalInput: " << V->getName() << "\n";
+// Names of the callees of some external calls, without duplicates
+static std::vector<std::string> getExternalCallees(ArrayRef<CallInst*> calls) {
+    std::vector<std::string> names;
+    for (const CallInst *call : calls) {
+        std::string name = getCalleeName(call).str();
+        if (!is_contained(names, name)) {
+            names.push_back(std::move(name));
+        }
+    }
+    return names;
+}
 
-        if (auto *callInst = dyn_cast<CallInst>(V)) {
-            if (Function *calledFunc = callInst->getCalledFunction()) {
-                errs() << "  called function: " << calledFunc->getName() << "\n";
-                if (calledFunc->getName().contains("scanf")) {
-                    errs() << "\t  --- SEMINAL INPUT ---\n";
-                    errs() << "\t   Value originates from scanf: " << *callInst << " --\n";
-                }
+static BranchRecord makeBranchRecord(const BranchFinding &finding) {
+    BranchRecord record;
+    record.function = finding.Br->getFunction()->getName().str();
+    record.loc = getSourceLocation(finding.Br);
+    record.kind = getControlFlowKind(finding.Br).str();
+    record.truncated = finding.Truncated;
+    for (CallInst *source : finding.Sources) {
+        record.sources.push_back(makeSourceRecord(source));
+    }
+    record.externalCalls = getExternalCallees(finding.ExternalCalls);
+    return record;
+}
 
-                if (calledFunc->getName().contains("getc")) {
-                    errs() << "\t  --- SEMINAL INPUT ---\n";
-                    errs() << "\t   Value from a call to getc\n";
+// Findings of a module, or of one function in parallel mode. They are kept
+// in memory and written out once the whole module has been traced.
+struct SeminalReport {
+    std::string trace;  // human readable trace, only kept for the text format
+    std::vector<BranchFinding> branches;
+    std::vector<BranchRecord> records;  // branches for the structured formats
 
-                    Value *arg = callInst->getArgOperand(0);    // Get the first argument
-                    errs() << "\t  Argument passed to getc: " << *arg << "\n";
-                }
+    // Functions and globals the trace walked through
+    SmallPtrSet<const Function*, 4> visitedFunctions;
+    SmallPtrSet<const GlobalVariable*, 4> visitedGlobals;
+    size_t visitedValues = 0;
+};
 
-                if (calledFunc->getName().contains("fopen")) {
-                    errs() << "\t  --- SEMINAL INPUT ---\n";
-                    errs() << "\t   Value from a call to fopen\n";
+static cl::opt<std::string> SourcesFile("seminal-sources",
+    cl::desc("File listing additional seminal input functions"),
+    cl::value_desc("filename"), cl::init(""));
 
-                    Value *arg = callInst->getArgOperand(0);    // Get the first argument
-                    errs() << "\t  Argument passed to fopen: " << *arg << "\n";
-                }
-                if (calledFunc->getName().contains("fwrite")) {
-                    errs() << "\t  --- SEMINAL INPUT ---\n";
-                    errs() << "\t   Value from a call to fwrite\n";
+// A seminal input function, matched by exact name or by name prefix
+struct SourceSpec {
+    std::string name;
+    std::string label;  // name shown in the trace, e.g. scanf for __isoc99_scanf
+    bool prefix;
+};
 
-                    Value *arg = callInst->getArgOperand(0);    // Get the first argument
-                    errs() << "\t  Argument passed to fwrite: " << *arg << "\n";
-                }
-                if (calledFunc->getName().contains("fclose")) {
-                    errs() << "\t  --- SEMINAL INPUT ---\n";
-                    errs() << "\t   Value from a call to fclose\n";
+static const SourceSpec DefaultSources[] = {
+    {"scanf", "scanf", false},
+    {"fscanf", "scanf", false},
+    {"sscanf", "scanf", false},
+    {"vscanf", "scanf", false},
+    {"vfscanf", "scanf", false},
+    {"vsscanf", "scanf", false},
+    {"__isoc99_scanf", "scanf", false},
+    {"__isoc99_fscanf", "scanf", false},
+    {"__isoc99_sscanf", "scanf", false},
+    {"__isoc99_vscanf", "scanf", false},
+    {"__isoc99_vfscanf", "scanf", false},
+    {"__isoc99_vsscanf", "scanf", false},
+    {"getc", "getc", false},
+    {"fgetc", "getc", false},
+    {"_IO_getc", "getc", false},
+    {"getc_unlocked", "getc", false},
+    {"fgetc_unlocked", "getc", false},
+    {"getchar", "getc", false},
+    {"getchar_unlocked", "getc", false},
+    {"fopen", "fopen", false},
+    {"fopen64", "fopen", false},
+    {"fwrite", "fwrite", false},
+    {"fwrite_unlocked", "fwrite", false},
+    {"fclose", "fclose", false},
+    {"fread", "fread", false},
+    {"fread_unlocked", "fread", false},
+};
 
-                    Value *arg = callInst->getArgOperand(0);    // Get the first argument
-                    errs() << "\t  Argument passed to fclose: " << *arg << "\n";
-                }
-                if (calledFunc->getName().contains("fread")) {
-                    errs() << "\t  --- SEMINAL INPUT ---\n";
-                    errs() << "\t   Value from a call to fread\n";
+// The seminal input functions of a module. The table is resolved against the
+// functions the module declares once, so classifying a call is a single
+// lookup of its callee.
+struct SourceTable {
+    std::vector<SourceSpec> specs;
+    DenseMap<const Function*, const SourceSpec*> sources;
 
-                    Value *arg = callInst->getArgOperand(0);    // Get the first argument
-                    errs() << "\t  Argument passed to fread: " << *arg << "\n";
-                }
+    SourceTable() : specs(std::begin(DefaultSources), std::end(DefaultSources)) {}
+
+    // Each line of the file names one function, optionally followed by the
+    // label to show in the trace. A trailing '*' matches a name prefix, and
+    // lines starting with '#' are comments:
+    //   getline
+    //   __isoc99_scanf scanf
+    //   recv* recv
+    bool loadFile(StringRef path) {
+        ErrorOr<std::unique_ptr<MemoryBuffer>> buffer = MemoryBuffer::getFile(path);
+        if (!buffer) {
+            errs() << "error: cannot read seminal input list '" << path << "': " << buffer.getError().message() << "\n";
+            return false;
+        }
 
+        SmallVector<StringRef, 32> lines;
+        (*buffer)->getBuffer().split(lines, '\n', -1, false);
+        for (StringRef line : lines) {
+            line = line.trim();
+            if (line.empty() || line.startswith("#")) {
+                continue;
             }
-        } 
+            std::pair<StringRef, StringRef> fields = getToken(line);
+            StringRef name = fields.first;
+            StringRef label = fields.second.trim();
+            bool prefix = name.consume_back("*");
+            specs.push_back({name.str(), (label.empty() ? name : label).str(), prefix});
+        }
+        return true;
     }
 
-    void findDefUseChains(llvm::Value *Val) {
-        errs() << "\tfindDefUseChains()\n";
-        for (auto *User : Val->users()) {
-            // errs() << "\t   DefUseChain value is used in: " << *User << "\n";
+    void resolve(Module &M) {
+        StringMap<const SourceSpec*> exact;
+        std::vector<const SourceSpec*> prefixes;
+        for (const SourceSpec &spec : specs) {
+            if (spec.prefix) {
+                prefixes.push_back(&spec);
+            } else {
+                exact.try_emplace(spec.name, &spec);
+            }
+        }
 
-            if (auto *instr = llvm::dyn_cast<llvm::Instruction>(User)) {
-                checkBeforeTrace(instr);
-            }   
+        for (Function &F : M) {
+            StringRef name = F.getName();
+            if (const SourceSpec *spec = exact.lookup(name)) {
+                sources[&F] = spec;
+                continue;
+            }
+            for (const SourceSpec *spec : prefixes) {
+                if (name.startswith(spec->name)) {
+                    sources[&F] = spec;
+                    break;
+                }
+            }
         }
     }
 
-    bool isInstructionInVector(const std::vector<Instruction*>& instructions, Instruction* inst) {
-        // Use std::find to check if the instruction is already in the vector
-        return std::find(instructions.begin(), instructions.end(), inst) != instructions.end();
+    const SourceSpec *lookup(const Function *F) const {
+        return sources.lookup(F);
+    }
+
+    // Identifies the table in cache keys
+    uint64_t hash() const {
+        std::string key;
+        for (const SourceSpec &spec : specs) {
+            key += spec.name + (spec.prefix ? "*" : "") + " " + spec.label + "\n";
+        }
+        return xxHash64(key);
     }
+};
 
-    std::vector<Instruction*> traced_instructions;
-    std::unordered_set<Value*> seenOperands;
+// Where a variable is declared in the source
+struct DeclLocation {
+    StringRef dir;
+    StringRef file;
+    unsigned line;
+    unsigned col;
+};
 
-    void checkBeforeTrace(Instruction *Inst) {
-        if (isInstructionInVector(traced_instructions, Inst) && isInstructionInVector(checked_seminal_inputs, Inst) ) {
-            return;
-        } else if (!isInstructionInVector(traced_instructions, Inst)) {
-            traced_instructions.push_back(Inst);
-        } else if (!isInstructionInVector(checked_seminal_inputs, Inst)) {
-            checked_seminal_inputs.push_back(Inst);
+// Declaration locations of the variables of a module (allocas, arguments and
+// globals), read once from their debug info
+struct DebugInfoIndex {
+    DenseMap<const Value*, DeclLocation> locations;
+
+    void build(Module &M) {
+        for (GlobalVariable &GV : M.globals()) {
+            SmallVector<DIGlobalVariableExpression*, 1> GVEs;
+            GV.getDebugInfo(GVEs);
+            if (!GVEs.empty()) {
+                DIGlobalVariable *Var = GVEs.front()->getVariable();
+                locations[&GV] = {Var->getDirectory(), Var->getFilename(), Var->getLine(), 0};
+            }
+        }
+
+        for (Function &F : M) {
+            addFunction(F);
         }
+    }
 
-        checkSeminalInput(Inst);
+    void addFunction(Function &F) {
+        for (Instruction &I : instructions(F)) {
+            if (auto *DVI = dyn_cast<DbgVariableIntrinsic>(&I)) {
+                addVariable(F, DVI);
+            }
+        }
+    }
 
-        for (Use &U : Inst->operands()) {
-            Value *Operand = U.get();
+    // Drop the locations of a function whose body is about to be deleted
+    void removeFunction(Function &F) {
+        for (Argument &A : F.args()) {
+            locations.erase(&A);
+        }
+        for (Instruction &I : instructions(F)) {
+            locations.erase(&I);
+        }
+    }
 
-            if (seenOperands.find(Operand) != seenOperands.end()) {
-                continue; // Skip duplicate operand
+    // dbg.declare/dbg.value describe the alloca or argument holding a variable.
+    // Parameters are also recorded for their Argument, found by number.
+    void addVariable(Function &F, DbgVariableIntrinsic *DVI) {
+        DILocalVariable *Var = DVI->getVariable();
+        DeclLocation Loc = {Var->getDirectory(), Var->getFilename(), Var->getLine(), 0};
+        if (DebugLoc debugLoc = DVI->getDebugLoc()) {
+            if (debugLoc.getLine() == Var->getLine()) {
+                Loc.col = debugLoc.getCol();
             }
-            seenOperands.insert(Operand);
+        }
 
-            // errs() << "\t   Operand: " << *Operand << "\n";
-            checkSeminalInput(Operand);
-            traceVariableOrigin(Operand); // Recursively trace the operand
+        if (DVI->getNumVariableLocationOps() > 0) {
+            Value *V = DVI->getVariableLocationOp(0);
+            if (V && (isa<AllocaInst>(V) || isa<Argument>(V))) {
+                locations.try_emplace(V, Loc);
+            }
+        }
+        unsigned argNo = Var->getArg();
+        if (argNo > 0 && argNo <= F.arg_size() && Var->getScope()->getSubprogram() == F.getSubprogram()) {
+            locations.try_emplace(F.getArg(argNo - 1), Loc);
         }
     }
 
-    void traceVariableOrigin(Value *V) {        
+    const DeclLocation *lookup(const Value *V) const {
+        auto It = locations.find(V);
+        return It == locations.end() ? nullptr : &It->second;
+    }
+};
 
-        // If it's an argument, print and return
-        if (isa<Argument>(V)) {
-            errs() << "\tVariable originates as a function argument: " << *V << "\n";
-            printValueName(V);
-            printValueSourceLocation(V);
-            findDefUseChains(V);
+static cl::list<std::string> QueryFunctions("seminal-function",
+    cl::desc("Only trace the branches of these functions (a trailing * matches a name prefix)"),
+    cl::value_desc("name"), cl::CommaSeparated);
+
+static cl::list<std::string> QueryLines("seminal-line",
+    cl::desc("Only trace the branches at these source lines, given as file:line or file:first-last"),
+    cl::value_desc("file:line"), cl::CommaSeparated);
+
+static cl::list<unsigned> QueryBranches("seminal-branch",
+    cl::desc("Only trace the branches with these ids in the jsonl and csv reports of a full run"),
+    cl::value_desc("id"), cl::CommaSeparated);
+
+// Conditional branches selected by -seminal-function, -seminal-line and
+// -seminal-branch, which all have to match. Every conditional branch of the
+// module is numbered in report order, so the selected ones keep the ids of a
+// full report. Without a query all branches are traced.
+struct BranchQuery {
+    struct LineRange {
+        std::string file;
+        unsigned first, last;
+    };
+
+    std::vector<LineRange> lines;
+    DenseSet<unsigned> branchIds;
+    DenseMap<const Instruction*, unsigned> selected;  // with their ids
+    DenseSet<const Function*> functions;             // with selected branches
+    unsigned nextId = 0;
+
+    static bool isRequested() {
+        return !QueryFunctions.empty() || !QueryLines.empty() || !QueryBranches.empty();
+    }
+
+    void build(Module &M) {
+        if (!isRequested()) {
             return;
         }
+        for (const std::string &spec : QueryLines) {
+            auto [file, range] = StringRef(spec).rsplit(':');
+            auto [first, last] = range.split('-');
+            LineRange lineRange{file.str(), 0, 0};
+            bool valid = !file.empty() && !first.getAsInteger(10, lineRange.first);
+            lineRange.last = lineRange.first;
+            if (valid && !last.empty()) {
+                valid = !last.getAsInteger(10, lineRange.last);
+            }
+            if (!valid) {
+                errs() << "error: invalid -seminal-line '" << spec << "', expected file:line or file:first-last\n";
+                continue;
+            }
+            lines.push_back(std::move(lineRange));
+        }
+        branchIds.insert(QueryBranches.begin(), QueryBranches.end());
+        for (Function &F : M) {
+            addFunction(F);
+        }
+    }
 
-        // If it's an alloca instruction, it's a local variable
-        if (AllocaInst *AI = dyn_cast<AllocaInst>(V)) {
-            errs() << "\tVariable originates from an alloca: " << *AI << "\n";
-            printValueName(V);
-            printValueSourceLocation(V);
-            findDefUseChains(V);
+    // Number the branches of a function, called in module order
+    void addFunction(Function &F) {
+        if (!isRequested()) {
             return;
         }
+        bool nameMatches = QueryFunctions.empty() || any_of(QueryFunctions, [&](StringRef pattern) {
+            return pattern.consume_back("*") ? F.getName().startswith(pattern) : F.getName() == pattern;
+        });
+        for (Instruction &I : instructions(F)) {
+            if (!getDecidingValue(I)) {
+                continue;
+            }
+            unsigned id = nextId++;
+            if (nameMatches && (branchIds.empty() || branchIds.count(id)) && (QueryLines.empty() || matchesLine(&I))) {
+                selected[&I] = id;
+                functions.insert(&F);
+            }
+        }
+    }
 
-        // If it's a global variable
-        if (GlobalVariable *GV = dyn_cast<GlobalVariable>(V)) {
-            errs() << "\tVariable originates from a global variable: " << *GV << "\n";
-            printValueName(V);
-            printValueSourceLocation(V);
-            findDefUseChains(V);
-            return;
+    // Drop the branches of a function whose body is about to be deleted
+    void removeFunction(Function &F) {
+        for (Instruction &I : instructions(F)) {
+            selected.erase(&I);
         }
+    }
 
-        // If it's a store instruction
-        if (StoreInst *SI = dyn_cast<StoreInst>(V)) {
-            errs() << "\tVariable defined by store instruction: " << *SI << "\n";
-            printValueName(V);
-            printValueSourceLocation(V);
-            findDefUseChains(V);
-            return;
+    // A file matches the file of the branch or a trailing part of its path
+    bool matchesLine(const Instruction *br) const {
+        SourceLocation Loc = getSourceLocation(br);
+        StringRef path(Loc.file);
+        return any_of(lines, [&](const LineRange &range) {
+            return Loc.line >= range.first && Loc.line <= range.last &&
+                   (path == range.file || path.endswith("/" + range.file));
+        });
+    }
+
+    bool selects(const Function &F) const {
+        return !isRequested() || functions.count(&F);
+    }
+
+    bool selects(const Instruction *br) const {
+        return !isRequested() || selected.count(br);
+    }
+
+    std::optional<unsigned> idOf(const Instruction *br) const {
+        auto It = selected.find(br);
+        return It == selected.end() ? std::nullopt : std::optional<unsigned>(It->second);
+    }
+};
+
+static cl::opt<bool> Interprocedural("seminal-interprocedural",
+    cl::desc("Follow seminal inputs through calls using per-function summaries"), cl::init(false));
+
+static cl::opt<std::string> SummaryDir("seminal-summary-dir",
+    cl::desc("Write a link summary of the module to this directory, so that seminal_link.py can follow "
+             "seminal inputs across translation units (implies -seminal-interprocedural)"),
+    cl::value_desc("directory"), cl::init(""));
+
+static cl::opt<std::string> FuzzDir("seminal-fuzz-dir",
+    cl::desc("Write a fuzzing dictionary and branch priorities of the module to this directory"),
+    cl::value_desc("directory"), cl::init(""));
+
+static bool useInterprocedural() {
+    return Interprocedural || !SummaryDir.empty();
+}
+
+// Seminal input call sites (scanf, getc, fopen, ...) reachable from a value
+using SourceSet = SmallSetVector<CallInst*, 4>;
+
+// Interprocedural summary of a function
+struct FunctionSummary {
+    // Sources stored through pointer arguments
+    SourceSet outSources;
+    // Sources reaching the return value or stored through pointer arguments,
+    // i.e. what a call to the function yields
+    SourceSet callSources;
+    // Sources passed to each argument by the callers
+    std::vector<SourceSet> argSources;
+};
+
+// Module-level summary of a global variable, see computeGlobalSummaries
+struct GlobalSummary {
+    // Sources reaching the global through any of its users
+    SourceSet sources;
+    // Functions and globals its trace walked through
+    SmallPtrSet<const Function*, 4> functions;
+    SmallPtrSet<const GlobalVariable*, 4> globals;
+};
+
+// Read-only information about a module, computed once and shared by all
+// tracers of the module
+struct ModuleInfo {
+    SourceTable sources;
+    DebugInfoIndex debugInfo;
+    BranchQuery query;
+    DenseMap<const Function*, FunctionSummary> summaries;  // with -seminal-interprocedural
+    DenseMap<const Function*, MemorySSA*> memorySSA;       // with -seminal-memoryssa
+    DenseMap<const GlobalVariable*, GlobalSummary> globalSummaries;
+
+    const FunctionSummary *lookupSummary(const Function *F) const {
+        auto It = summaries.find(F);
+        return It == summaries.end() ? nullptr : &It->second;
+    }
+
+    // What the result of a call to a summarized function yields, or null if
+    // V is not such a call. A call reached as a user of one of its arguments
+    // only adds the outSources it stores through them.
+    const SourceSet *lookupCallSources(const Value *V) const {
+        auto *callInst = dyn_cast<CallInst>(V);
+        Function *callee = callInst ? callInst->getCalledFunction() : nullptr;
+        const FunctionSummary *summary = callee ? lookupSummary(callee) : nullptr;
+        return summary && !summary->callSources.empty() ? &summary->callSources : nullptr;
+    }
+
+    // Merges the summary of a global into report and sources, returning
+    // false if the global has none
+    bool useGlobalSummary(const GlobalVariable *GV, SeminalReport &report, SourceSet &found) const {
+        auto It = globalSummaries.find(GV);
+        if (It == globalSummaries.end()) {
+            return false;
         }
+        const GlobalSummary &summary = It->second;
+        found.insert(summary.sources.begin(), summary.sources.end());
+        report.visitedFunctions.insert(summary.functions.begin(), summary.functions.end());
+        report.visitedGlobals.insert(summary.globals.begin(), summary.globals.end());
+        ++NumGlobalSummaryUses;
+        return true;
+    }
 
-        // If it's defined by an instruction, trace back its operands
-        if (Instruction *Inst = dyn_cast<Instruction>(V)) {
-            if (isInstructionInVector(traced_instructions, Inst)) {
-                return;
+    // With -seminal-summary-dir, calls to functions defined in another module
+    // are traced like seminal inputs, and resolved by the link step to the
+    // seminal inputs their definition yields
+    bool isExternalCall(const Function *callee) const {
+        return !SummaryDir.empty() && callee->isDeclaration() && !callee->isIntrinsic() && !sources.lookup(callee);
+    }
+
+    explicit ModuleInfo(Module &M) {
+        TimeTraceScope timeScope("SeminalModuleInfo", M.getSourceFileName());
+        if (!SourcesFile.empty()) {
+            sources.loadFile(SourcesFile);
+        }
+        sources.resolve(M);
+        debugInfo.build(M);
+        query.build(M);
+    }
+};
+
+// The finding of a branch, with the external calls among the values found
+// set apart from the seminal inputs
+static BranchFinding makeFinding(Instruction *br, ArrayRef<CallInst*> found, bool truncated,
+                                 const ModuleInfo &moduleInfo) {
+    BranchFinding finding{br, {}, truncated, {}};
+    for (CallInst *call : found) {
+        if (moduleInfo.isExternalCall(call->getCalledFunction())) {
+            finding.ExternalCalls.push_back(call);
+        } else {
+            finding.Sources.push_back(call);
+        }
+    }
+    return finding;
+}
+
+// Returns true if V, or V cast to another type, is stored into one of objects
+static bool isStoredInto(Value *V, const SmallPtrSetImpl<const Value*> &objects) {
+    for (User *U : V->users()) {
+        if (auto *store = dyn_cast<StoreInst>(U)) {
+            if (store->getValueOperand() == V && objects.count(getUnderlyingObject(store->getPointerOperand()))) {
+                return true;
             }
-            errs() << "Tracing variable defined by instruction: " << *Inst << "\n";
-            checkBeforeTrace(Inst);
+        } else if (isa<CastInst>(U) && isStoredInto(U, objects)) {
+            return true;
         }
     }
+    return false;
+}
 
-    PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM) {
+// With -seminal-fuzz-dir, what a fuzzer needs to know about a branch: which
+// arguments of each seminal input call feed it (the index of a pointer
+// argument the branch reads memory through, -1 for the return value used
+// or stored where the branch reads it, none when it flows elsewhere, e.g.
+// through a call), and the constants its condition
+// compares against, as input bytes. The condition is followed back within
+// its function through operands up to loads and calls.
+static void addFuzzInfo(BranchRecord &record, const BranchFinding &finding, const ModuleInfo &moduleInfo) {
+    if (finding.Sources.empty()) {
+        return;
+    }
+    SmallPtrSet<Value*, 16> visited;
+    SmallPtrSet<const Value*, 8> objects;  // memory read by the loads reached
+    SmallVector<std::pair<ConstantInt*, Value*>, 4> compares;  // constant, compared value
+    SmallVector<Value*, 16> worklist = {getDecidingValue(*finding.Br)};
+    if (auto *SI = dyn_cast<SwitchInst>(finding.Br)) {
+        for (auto &Case : SI->cases()) {
+            compares.push_back({Case.getCaseValue(), SI->getCondition()});
+        }
+    }
+    while (!worklist.empty()) {
+        Value *V = worklist.pop_back_val();
+        if (!visited.insert(V).second) {
+            continue;
+        }
+        if (auto *load = dyn_cast<LoadInst>(V)) {
+            objects.insert(getUnderlyingObject(load->getPointerOperand()));
+            continue;
+        }
+        auto *I = dyn_cast<Instruction>(V);
+        if (!I || isa<CallInst>(I) || isa<AllocaInst>(I)) {
+            continue;
+        }
+        if (auto *cmp = dyn_cast<ICmpInst>(I)) {
+            for (unsigned i = 0; i < 2; i++) {
+                if (auto *C = dyn_cast<ConstantInt>(cmp->getOperand(i))) {
+                    compares.push_back({C, cmp->getOperand(1 - i)});
+                }
+            }
+        }
+        worklist.append(I->op_begin(), I->op_end());
+    }
+
+    bool text = false;  // scanf parses the input as text
+    for (size_t i = 0; i < finding.Sources.size(); i++) {
+        CallInst *source = finding.Sources[i];
+        std::vector<int> &arguments = record.sources[i].arguments;
+        if (visited.count(source) || isStoredInto(source, objects)) {
+            arguments.push_back(-1);
+        }
+        for (unsigned arg = 0; arg < source->arg_size(); arg++) {
+            Value *operand = source->getArgOperand(arg);
+            if (operand->getType()->isPointerTy() && objects.count(getUnderlyingObject(operand))) {
+                arguments.push_back(arg);
+            }
+        }
+        const SourceSpec *spec = moduleInfo.sources.lookup(source->getCalledFunction());
+        text |= spec && spec->label == "scanf";
+    }
+
+    // Bytes are compared as characters, wider integers read by scanf as
+    // decimal numbers and other wider integers as their little-endian bytes.
+    // Characters returned by getc and the like are compared as int.
+    for (const auto &[C, compared] : compares) {
+        Value *input = compared;
+        while (auto *cast = dyn_cast<CastInst>(input)) {
+            input = cast->getOperand(0);
+        }
+        unsigned bits = input->getType()->getScalarSizeInBits();
+        const APInt &value = C->getValue();
+        std::string token;
+        if (bits == 8 || (isa<CallInst>(input) && !text)) {
+            if (value.getActiveBits() > 8 || value.isNegative()) {
+                continue;  // e.g. EOF
+            }
+            token.push_back(char(value.getZExtValue()));
+        } else if (text && bits > 8) {
+            token = toString(value, 10, /*Signed=*/true);
+        } else if (bits % 8 == 0 && bits <= 64) {
+            uint64_t raw = value.getZExtValue();
+            for (unsigned byte = 0; byte < bits / 8; byte++) {
+                token.push_back(char(raw >> (8 * byte)));
+            }
+        }
+        if (!token.empty() && !is_contained(record.tokens, token)) {
+            record.tokens.push_back(std::move(token));
+        }
+    }
+}
+
+// The record of a finding made by a tracer
+static BranchRecord makeBranchRecord(const BranchFinding &finding, const ModuleInfo &moduleInfo) {
+    BranchRecord record = makeBranchRecord(finding);
+    record.id = moduleInfo.query.idOf(finding.Br);
+    if (!FuzzDir.empty()) {
+        addFuzzInfo(record, finding, moduleInfo);
+    }
+    return record;
+}
 
-        for (auto &F : M) {
-            // errs() << "I see a function called " << F.getName() << "\n";
+static cl::opt<bool> SSAMode("seminal-ssa",
+    cl::desc("Run after the early SROA/mem2reg simplification and trace SSA def-use chains"),
+    cl::init(false));
 
-            for (auto &BB : F) {
-            //   errs() << "I see a basic block " << BB.getName() << "\n";
-              for (auto &I : BB) {
+static cl::opt<bool> MemorySSAMode("seminal-memoryssa",
+    cl::desc("Follow loads to their reaching stores and calls using MemorySSA"),
+    cl::init(false));
 
-                // errs() << "analyzing uses of: " << I << "\n";
-                
-                if (BranchInst *br = dyn_cast<BranchInst>(&I)) {
+static cl::opt<bool> FieldSensitive("seminal-field-sensitive",
+    cl::desc("Follow a struct field or array element to the accesses of the same field or element only"),
+    cl::init(false));
 
-                    if (br->isConditional()) {
-                        Value *condition = br->getCondition();
-                        // errs() << "branch instruction condition: " << condition << "\n";
-                        // checkBeforeTrace(condition);
-                        traceVariableOrigin(condition);                        
-                    }
-                    // else {
-                    //     errs() << "branch instruction: " << br->getSuccessor(0) << "\n";
-                    // }
+// The memory a GEP with constant indices from a local, global or argument
+// points to: size bytes at offset from the start of base
+struct AccessPath {
+    Value *base;
+    int64_t offset;
+    uint64_t size;
+};
+
+static const DataLayout &getDataLayout(Value *base) {
+    if (auto *GV = dyn_cast<GlobalValue>(base)) {
+        return GV->getParent()->getDataLayout();
+    }
+    if (auto *A = dyn_cast<Argument>(base)) {
+        return A->getParent()->getParent()->getDataLayout();
+    }
+    return cast<Instruction>(base)->getModule()->getDataLayout();
+}
+
+// With -seminal-field-sensitive, the access path of a GEP, instruction or
+// constant expression
+static bool getAccessPath(Value *V, AccessPath &path) {
+    auto *GEP = dyn_cast<GEPOperator>(V);
+    if (!FieldSensitive || !GEP || !GEP->getResultElementType()->isSized()) {
+        return false;
+    }
+    // Constant globals, such as format strings, hold no seminal input
+    Value *base = getUnderlyingObject(GEP);
+    auto *GV = dyn_cast<GlobalVariable>(base);
+    if ((!isa<AllocaInst>(base) && !GV && !isa<Argument>(base)) || (GV && GV->isConstant())) {
+        return false;
+    }
+    const DataLayout &DL = getDataLayout(base);
+    APInt offset(DL.getIndexTypeSizeInBits(GEP->getType()), 0);
+    if (GEP->stripAndAccumulateConstantOffsets(DL, offset, /*AllowNonInbounds=*/true) != base) {
+        return false;  // a variable index on the way
+    }
+    path = {base, offset.getSExtValue(), DL.getTypeStoreSize(GEP->getResultElementType()).getFixedSize()};
+    return true;
+}
+
+// The instructions that may read or write the memory of an access path: the
+// users of its base, and the users of the pointers derived from the base that
+// may overlap the path. Pointers at a variable offset and casts, whose
+// accesses can have any size, are assumed to overlap.
+static void collectPathUsers(const AccessPath &path, SmallVectorImpl<Value*> &users) {
+    const DataLayout &DL = getDataLayout(path.base);
+    SmallVector<Value*, 8> worklist = {path.base};
+    SmallPtrSet<Value*, 8> visited;
+    while (!worklist.empty()) {
+        Value *P = worklist.pop_back_val();
+        for (User *U : P->users()) {
+            if (!isa<GEPOperator>(U) && !isa<BitCastOperator>(U)) {
+                if (isa<Instruction>(U)) {
+                    users.push_back(U);
+                }
+                continue;
+            }
+            APInt offset(DL.getIndexTypeSizeInBits(U->getType()), 0);
+            if (U->stripAndAccumulateConstantOffsets(DL, offset, /*AllowNonInbounds=*/true) == path.base) {
+                int64_t start = offset.getSExtValue();
+                auto *GEP = dyn_cast<GEPOperator>(U);
+                bool disjoint = start >= path.offset + int64_t(path.size);
+                if (GEP && GEP->getResultElementType()->isSized()) {
+                    uint64_t size = DL.getTypeStoreSize(GEP->getResultElementType()).getFixedSize();
+                    disjoint |= start + int64_t(size) <= path.offset;
+                }
+                if (disjoint) {
+                    continue;
                 }
-              }
+            }
+            if (visited.insert(U).second) {
+                worklist.push_back(U);
             }
         }
-        return PreservedAnalyses::all();
+    }
+}
+
+static cl::opt<unsigned> MaxTraceDepth("seminal-max-depth",
+    cl::desc("Stop tracing a branch condition deeper than this many values (0: no limit)"),
+    cl::init(0));
+
+static cl::opt<unsigned> MaxBranchValues("seminal-max-branch-values",
+    cl::desc("Stop tracing a branch condition after visiting this many values (0: no limit)"),
+    cl::init(0));
+
+static cl::opt<unsigned> MaxFunctionValues("seminal-max-function-values",
+    cl::desc("Stop tracing the branches of a function after visiting this many values (0: no limit)"),
+    cl::init(0));
+
+static cl::opt<unsigned> MaxFunctionTime("seminal-max-function-ms",
+    cl::desc("Stop tracing the branches of a function after this many milliseconds (0: no limit)"),
+    cl::init(0));
+
+// Values reached by the traces of one function. Nodes and summaries are bump
+// allocated and released all at once when the function is done.
+class TraceGraph {
+public:
+    struct Node {
+        Value *V;
+        unsigned index;                // DFS index while the trace is in progress
+        bool finished = false;
+        ArrayRef<CallInst*> sources;   // summary of the node's SCC once finished
+
+        void finish(ArrayRef<CallInst*> summary) {
+            finished = true;
+            sources = summary;
+        }
     };
+
+    Node *addNode(Value *V, unsigned index) {
+        Node *node = new (allocator.Allocate<Node>()) Node{V, index};
+        nodes[V] = node;
+        return node;
+    }
+
+    const Node *lookup(Value *V) const {
+        return nodes.lookup(V);
+    }
+
+    void removeNode(Value *V) {
+        nodes.erase(V);
+    }
+
+    ArrayRef<CallInst*> copySources(const SourceSet &sources) {
+        if (sources.empty()) {
+            return {};
+        }
+        CallInst **copy = allocator.Allocate<CallInst*>(sources.size());
+        std::copy(sources.begin(), sources.end(), copy);
+        return makeArrayRef(copy, sources.size());
+    }
+
+    void clear() {
+        nodes.clear();
+        allocator.Reset();
+    }
+
+private:
+    BumpPtrAllocator allocator;
+    DenseMap<Value*, Node*> nodes;
 };
 
-}
+// Traces the conditions of conditional branches back to seminal inputs,
+// recording the findings in a SeminalReport
+struct SeminalTracer {
+    const ModuleInfo &moduleInfo;
+    SeminalReport &Report;
+    raw_string_ostream OS;
+    bool verbose;  // print the step by step trace into Report.trace
 
-extern "C" LLVM_ATTRIBUTE_WEAK ::llvm::PassPluginLibraryInfo
-llvmGetPassPluginInfo() {
-    return {
-        .APIVersion = LLVM_PLUGIN_API_VERSION,
-        .PluginName = "Skeleton pass",
-        .PluginVersion = "v0.1",
-        .RegisterPassBuilderCallbacks = [](PassBuilder &PB) {
-            PB.registerPipelineStartEPCallback(
-                [](ModulePassManager &MPM, OptimizationLevel Level) {
-                    MPM.addPass(SkeletonPass());
+    SeminalTracer(const ModuleInfo &moduleInfo, SeminalReport &Report, bool verbose)
+        : moduleInfo(moduleInfo), Report(Report), OS(Report.trace), verbose(verbose) {}
+
+    // Helper function to find the source location of an instruction
+    void printInstrDebugLocation(Instruction *I){
+        // Retrieve and print source location (if available)
+        if (DebugLoc debugLoc = I->getDebugLoc()) {
+            unsigned line = debugLoc.getLine();
+            unsigned col = debugLoc.getCol();
+            auto *scope = debugLoc->getScope();
+            StringRef file = scope->getFilename();
+            StringRef dir = scope->getDirectory();
+
+            OS << "\tSource Location: " << dir << "/" << file << ":" << line << ":" << col << "\n";
+        } else {
+            OS << "\tNo debug location available for this instruction.\n";
+        }
+    }
+
+    void printValueSourceLocation(Value *V) {
+        if (const DeclLocation *Loc = moduleInfo.debugInfo.lookup(V)) {
+            OS << "\tLocation: " << Loc->dir << "/" << Loc->file << ":" << Loc->line << ":" << Loc->col << "\n";
+        }
+    }
+
+    // Helper function to find the variable name associated with an instruction
+    void printValueName(Value *V) {
+        OS << "\tValue has name: " << V->hasName() << ", value name: " << V->getName() << "\n";
+    }
+
+    // Returns true if V is a call to one of the seminal input functions
+    bool checkSeminalInput(Value *V) {
+        // OS << "\t\tcheckSeminalInput: " << V->getName() << "\n";
+
+        auto *callInst = dyn_cast<CallInst>(V);
+        if (!callInst) {
+            return false;
+        }
+        Function *calledFunc = callInst->getCalledFunction();
+        if (!calledFunc) {
+            return false;
+        }
+        if (verbose) {
+            OS << "  called function: " << calledFunc->getName() << "\n";
+        }
+
+        const SourceSpec *spec = moduleInfo.sources.lookup(calledFunc);
+        if (!spec) {
+            return false;
+        }
+        ++NumSeminalInputs;
+        if (verbose) {
+            OS << "\t  --- SEMINAL INPUT ---\n";
+            if (spec->label == "scanf") {
+                OS << "\t   Value originates from scanf: " << *callInst << " --\n";
+            } else {
+                OS << "\t   Value from a call to " << spec->label << "\n";
+                if (callInst->arg_size() > 0) {
+                    Value *arg = callInst->getArgOperand(0);    // Get the first argument
+                    OS << "\t  Argument passed to " << spec->label << ": " << *arg << "\n";
+                }
+            }
+        }
+        return true;
+    }
+
+    // Trace graph of the function being traced, with memoized seminal-origin
+    // summaries. Values on a def-use cycle reach the same sources, so each
+    // strongly connected component of the graph shares a single summary.
+    TraceGraph graph;
+
+    // Tarjan's SCC stack of the values whose trace is still in progress
+    std::vector<TraceGraph::Node*> traceStack;
+    unsigned nextTraceIndex = 0;
+
+    // Low link returned for values that are summarized or never traced
+    static constexpr unsigned Finished = ~0u;
+
+    // Exploration budgets of the current branch and function
+    using Clock = std::chrono::steady_clock;
+    unsigned branchValues = 0;
+    unsigned functionValues = 0;
+    Clock::time_point functionStart = Clock::now();
+    unsigned stepsSinceClockCheck = 0;
+    bool outOfTime = false;
+    bool truncated = false;  // the last traceCondition ran out of budget
+
+    Function *currentFunction = nullptr;  // function whose values are traced
+
+    bool overBudget() {
+        if (MaxTraceDepth && depth > MaxTraceDepth) {
+            return true;
+        }
+        if (MaxBranchValues && branchValues > MaxBranchValues) {
+            return true;
+        }
+        if (MaxFunctionValues && functionValues > MaxFunctionValues) {
+            return true;
+        }
+        if (MaxFunctionTime && !outOfTime && ++stepsSinceClockCheck == 1024) {
+            stepsSinceClockCheck = 0;
+            outOfTime = Clock::now() - functionStart > std::chrono::milliseconds(MaxFunctionTime);
+        }
+        return outOfTime;
+    }
+
+    // Give up on the current branch. The sources found so far are kept, and
+    // the values still in progress are forgotten rather than summarized with
+    // partial results, so the summaries of later branches stay exact.
+    void abandonTrace() {
+        for (unsigned i = 1; i < depth; i++) {
+            workStack[0].sources.insert(workStack[i].sources.begin(), workStack[i].sources.end());
+        }
+        for (TraceGraph::Node *node : traceStack) {
+            graph.removeNode(node->V);
+        }
+        traceStack.clear();
+        depth = 1;
+        truncated = true;
+    }
+
+    unsigned beginTrace(Value *V) {
+        unsigned index = nextTraceIndex++;
+        traceStack.push_back(graph.addNode(V, index));
+        return index;
+    }
+
+    // Finish tracing V. If V is the root of its strongly connected component,
+    // VSources is complete and becomes the summary of the whole component.
+    unsigned endTrace(Value *V, unsigned index, unsigned low, const SourceSet &VSources, SourceSet &Sources) {
+        Sources.insert(VSources.begin(), VSources.end());
+        if (low < index) {
+            return low;
+        }
+
+        ArrayRef<CallInst*> summary = graph.copySources(VSources);
+        TraceGraph::Node *member;
+        do {
+            member = traceStack.back();
+            traceStack.pop_back();
+            member->finish(summary);
+        } while (member->V != V);
+        return Finished;
+    }
+
+    // A value whose trace is in progress. Origins (arguments, allocas, globals)
+    // continue with their users, loads with -seminal-memoryssa with their
+    // reaching definitions, access paths with -seminal-field-sensitive with
+    // the users of the same memory, other instructions with their operands.
+    struct TraceFrame {
+        Value *V = nullptr;
+        unsigned index = 0;
+        unsigned low = Finished;
+        bool followUsers = false;
+        bool followDefs = false;
+        bool followPath = false;
+        Value::user_iterator nextUser;
+        unsigned nextOperand = 0;  // next operand, or next entry of defs
+        SmallVector<Value*, 4> defs;  // reaching definitions or path users
+        SourceSet sources;
+    };
+
+    // Explicit DFS stack, reused across branches so the trace needs bounded
+    // native stack space however long the data-flow chain is. Frame 0 collects
+    // the sources of the branch condition being traced.
+    std::vector<TraceFrame> workStack;
+    unsigned depth = 0;
+
+    void pushFrame(Value *V, bool followUsers) {
+        if (depth == workStack.size()) {
+            workStack.emplace_back();
+        }
+        TraceFrame &F = workStack[depth++];
+        F.V = V;
+        F.index = beginTrace(V);
+        F.low = F.index;
+        F.followUsers = followUsers;
+        F.followDefs = false;
+        F.followPath = false;
+        if (followUsers) {
+            F.nextUser = V->user_begin();
+        }
+        F.nextOperand = 0;
+        F.sources.clear();
+        Report.visitedValues++;
+        branchValues++;
+        functionValues++;
+        ++NumValuesTraced;
+
+        if (auto *I = dyn_cast<Instruction>(V)) {
+            Report.visitedFunctions.insert(I->getFunction());
+        } else if (auto *A = dyn_cast<Argument>(V)) {
+            Report.visitedFunctions.insert(A->getParent());
+        } else if (auto *GV = dyn_cast<GlobalVariable>(V)) {
+            Report.visitedGlobals.insert(GV);
+        }
+    }
+
+    void popFrame() {
+        TraceFrame &F = workStack[--depth];
+        TraceFrame &Parent = workStack[depth - 1];
+        Parent.low = std::min(Parent.low, endTrace(F.V, F.index, F.low, F.sources, Parent.sources));
+    }
+
+    // Returns true if V needs no further tracing from the current frame,
+    // either because it is summarized or because it is still in progress.
+    bool alreadyTraced(Value *V) {
+        const TraceGraph::Node *node = graph.lookup(V);
+        if (!node) {
+            return false;
+        }
+        TraceFrame &Parent = workStack[depth - 1];
+        if (node->finished) {
+            Parent.sources.insert(node->sources.begin(), node->sources.end());
+            ++NumSummaryHits;
+        } else {
+            Parent.low = std::min(Parent.low, node->index);  // part of a def-use cycle
+            ++NumCycleSkips;
+        }
+        return true;
+    }
+
+    // Instructions reached through a def-use chain or through
+    // traceVariableOrigin get their operands traced back
+    void checkBeforeTrace(Instruction *Inst) {
+        if (alreadyTraced(Inst)) {
+            return;
+        }
+
+        bool isSeminal = checkSeminalInput(Inst);
+        if (auto *callInst = dyn_cast<CallInst>(Inst)) {
+            Function *callee = callInst->getCalledFunction();
+            isSeminal |= callee && moduleInfo.isExternalCall(callee);
+        }
+        pushFrame(Inst, false);
+        if (isSeminal) {
+            workStack[depth - 1].sources.insert(cast<CallInst>(Inst));
+        }
+
+        AccessPath path;
+        if (getAccessPath(Inst, path)) {
+            followAccessPath(path);
+            return;
+        }
+
+        // MemorySSA is only queried for the function being traced, which no
+        // other thread touches in parallel mode
+        if (auto *load = dyn_cast<LoadInst>(Inst)) {
+            MemorySSA *MSSA = load->getFunction() == currentFunction
+                ? moduleInfo.memorySSA.lookup(currentFunction) : nullptr;
+            if (MSSA) {
+                TraceFrame &F = workStack[depth - 1];
+                F.followDefs = true;
+                F.defs.clear();
+                collectReachingDefs(load, *MSSA, F.defs);
+                if (verbose) {
+                    for (Value *def : F.defs) {
+                        OS << "\tReaching definition of load: " << *def << "\n";
+                    }
+                }
+            }
+        }
+
+        // A call to a defined function stores the out sources of its summary
+        // through its pointer arguments, however the call is reached
+        if (auto *callInst = dyn_cast<CallInst>(Inst)) {
+            if (Function *calledFunc = callInst->getCalledFunction()) {
+                const FunctionSummary *summary = moduleInfo.lookupSummary(calledFunc);
+                if (summary && !summary->outSources.empty()) {
+                    ++NumFunctionSummaryUses;
+                    workStack[depth - 1].sources.insert(summary->outSources.begin(), summary->outSources.end());
+                }
+            }
+        }
+    }
+
+    // Returns true if a store overwrites all of the memory read by a load, so
+    // that no earlier definition can reach the load past it
+    static bool overwritesLoad(const StoreInst *store, const LoadInst *load) {
+        const DataLayout &DL = load->getModule()->getDataLayout();
+        return store->getPointerOperand()->stripPointerCasts() == load->getPointerOperand()->stripPointerCasts()
+            && DL.getTypeStoreSize(store->getValueOperand()->getType()) >= DL.getTypeStoreSize(load->getType());
+    }
+
+    // The stores and calls that may write the memory read by a load, found by
+    // MemorySSA clobber queries through memory phis. The walk continues above
+    // the definitions that may only partially or possibly write the memory.
+    // The indices and base of the address are added as well, and the pointer
+    // itself when memory from outside the function reaches the load.
+    static void collectReachingDefs(LoadInst *load, MemorySSA &MSSA, SmallVectorImpl<Value*> &defs) {
+        MemorySSAWalker *walker = MSSA.getWalker();
+        MemoryLocation loc = MemoryLocation::get(load);
+        SmallVector<MemoryAccess*, 8> worklist = {walker->getClobberingMemoryAccess(load)};
+        SmallPtrSet<MemoryAccess*, 8> visited;
+        bool fromEntry = false;
+        while (!worklist.empty()) {
+            MemoryAccess *MA = worklist.pop_back_val();
+            if (!visited.insert(MA).second) {
+                continue;
+            }
+            if (MSSA.isLiveOnEntryDef(MA)) {
+                fromEntry = true;
+            } else if (auto *phi = dyn_cast<MemoryPhi>(MA)) {
+                for (Use &incoming : phi->incoming_values()) {
+                    worklist.push_back(walker->getClobberingMemoryAccess(cast<MemoryAccess>(incoming), loc));
+                }
+            } else if (auto *def = dyn_cast<MemoryDef>(MA)) {
+                Instruction *I = def->getMemoryInst();
+                defs.push_back(I);
+                auto *store = dyn_cast<StoreInst>(I);
+                if (!store || !overwritesLoad(store, load)) {
+                    worklist.push_back(walker->getClobberingMemoryAccess(def->getDefiningAccess(), loc));
+                }
+            }
+        }
+        // The address is followed too, since an index read from input selects
+        // which element is loaded. A local base is not: its users are the
+        // stores already found above.
+        Value *ptr = load->getPointerOperand();
+        while (true) {
+            if (auto *gep = dyn_cast<GEPOperator>(ptr)) {
+                for (Value *index : gep->indices()) {
+                    if (!isa<Constant>(index)) {
+                        defs.push_back(index);
+                    }
+                }
+                ptr = gep->getPointerOperand();
+            } else if (auto *cast = dyn_cast<BitCastOperator>(ptr)) {
+                ptr = cast->getOperand(0);
+            } else {
+                break;
+            }
+        }
+        if (isa<Instruction>(ptr) && !isa<AllocaInst>(ptr)) {
+            defs.push_back(ptr);
+        } else if (fromEntry && !isa<AllocaInst>(getUnderlyingObject(ptr))) {
+            // Uninitialized locals have no definition to follow
+            defs.push_back(load->getPointerOperand());
+        }
+    }
+
+    // Print an origin value (argument, alloca, global) and follow its users.
+    // In SSA form the users of a scalar argument cannot redefine it, so only
+    // memory, including memory behind pointer arguments, is followed forward.
+    void traceOriginUsers(Value *V) {
+        bool followUsers = !(SSAMode && isa<Argument>(V) && !V->getType()->isPointerTy());
+        if (verbose) {
+            printValueName(V);
+            printValueSourceLocation(V);
+            if (followUsers) {
+                OS << "\tfindDefUseChains()\n";
+            }
+        }
+        pushFrame(V, followUsers);
+
+        // Arguments receive the sources the callers pass in
+        if (auto *arg = dyn_cast<Argument>(V)) {
+            const FunctionSummary *summary = moduleInfo.lookupSummary(arg->getParent());
+            if (summary && !summary->argSources[arg->getArgNo()].empty()) {
+                const SourceSet &argSources = summary->argSources[arg->getArgNo()];
+                ++NumFunctionSummaryUses;
+                if (verbose) {
+                    OS << "\tArgument receives seminal inputs from callers of " << arg->getParent()->getName() << "\n";
+                }
+                workStack[depth - 1].sources.insert(argSources.begin(), argSources.end());
+            }
+        }
+    }
+
+    // Continue the frame on top of the work stack, a GEP, with the users of
+    // the memory it points to instead of with its operands
+    void followAccessPath(const AccessPath &path) {
+        TraceFrame &F = workStack[depth - 1];
+        F.followPath = true;
+        F.defs.clear();
+        collectPathUsers(path, F.defs);
+        if (verbose) {
+            OS << "\tAccess path: " << path.base->getName() << " + " << path.offset << ", " << path.size
+               << " bytes, " << F.defs.size() << " users\n";
+        }
+
+        if (auto *GV = dyn_cast<GlobalVariable>(path.base)) {
+            Report.visitedGlobals.insert(GV);
+        } else if (auto *arg = dyn_cast<Argument>(path.base)) {
+            const FunctionSummary *summary = moduleInfo.lookupSummary(arg->getParent());
+            if (summary && !summary->argSources[arg->getArgNo()].empty()) {
+                const SourceSet &argSources = summary->argSources[arg->getArgNo()];
+                ++NumFunctionSummaryUses;
+                F.sources.insert(argSources.begin(), argSources.end());
+            }
+        }
+    }
+
+    // Schedule V, an operand of the value on top of the work stack, for tracing
+    void traceVariableOrigin(Value *V) {
+        // The result of a call to a defined function yields the sources of
+        // its summary
+        if (const SourceSet *callSources = moduleInfo.lookupCallSources(V)) {
+            ++NumFunctionSummaryUses;
+            if (verbose) {
+                OS << "\tUsing summary of called function: "
+                   << cast<CallInst>(V)->getCalledFunction()->getName() << "\n";
+            }
+            workStack[depth - 1].sources.insert(callSources->begin(), callSources->end());
+        }
+        if (alreadyTraced(V)) {
+            return;
+        }
+
+        // If it's an argument, print and return
+        if (isa<Argument>(V)) {
+            if (verbose) {
+                OS << "\tVariable originates as a function argument: " << *V << "\n";
+            }
+            traceOriginUsers(V);
+            return;
+        }
+
+        // If it's an alloca instruction, it's a local variable
+        if (AllocaInst *AI = dyn_cast<AllocaInst>(V)) {
+            if (verbose) {
+                OS << "\tVariable originates from an alloca: " << *AI << "\n";
+            }
+            traceOriginUsers(V);
+            return;
+        }
+
+        // If it's a global variable
+        if (GlobalVariable *GV = dyn_cast<GlobalVariable>(V)) {
+            if (moduleInfo.useGlobalSummary(GV, Report, workStack[depth - 1].sources)) {
+                return;
+            }
+            if (verbose) {
+                OS << "\tVariable originates from a global variable: " << *GV << "\n";
+            }
+            traceOriginUsers(V);
+            return;
+        }
+
+        // If it's a store instruction
+        if (StoreInst *SI = dyn_cast<StoreInst>(V)) {
+            if (verbose) {
+                OS << "\tVariable defined by store instruction: " << *SI << "\n";
+            }
+            traceOriginUsers(V);
+            return;
+        }
+
+        // A field or element of a global, addressed by a constant expression
+        AccessPath path;
+        if (isa<ConstantExpr>(V) && getAccessPath(V, path)) {
+            pushFrame(V, false);
+            followAccessPath(path);
+            return;
+        }
+
+        // If it's defined by an instruction, trace back its operands
+        if (Instruction *Inst = dyn_cast<Instruction>(V)) {
+            if (verbose) {
+                OS << "Tracing variable defined by instruction: " << *Inst << "\n";
+            }
+            checkBeforeTrace(Inst);
+        }
+    }
+
+    // Collect the seminal sources reachable from a branch condition. Values
+    // are traced once per function; later traces reaching them reuse their
+    // summary. The result stays valid until the next call.
+    const SourceSet &traceCondition(Value *Cond) {
+        if (workStack.empty()) {
+            workStack.resize(64);
+        }
+        depth = 1;
+        workStack[0].sources.clear();
+        branchValues = 0;
+        truncated = false;
+
+        traceVariableOrigin(Cond);
+        while (depth > 1) {
+            if (overBudget()) {
+                abandonTrace();
+                break;
+            }
+            TraceFrame &F = workStack[depth - 1];
+            if (F.followUsers) {
+                if (F.nextUser != F.V->user_end()) {
+                    User *U = *F.nextUser++;
+                    // OS << "\t   DefUseChain value is used in: " << *U << "\n";
+                    if (auto *instr = dyn_cast<Instruction>(U)) {
+                        checkBeforeTrace(instr);
+                    }
+                    continue;
+                }
+            } else if (F.followDefs) {
+                if (F.nextOperand < F.defs.size()) {
+                    Value *def = F.defs[F.nextOperand++];
+                    if (auto *store = dyn_cast<StoreInst>(def)) {
+                        traceVariableOrigin(store->getValueOperand());
+                    } else {
+                        traceVariableOrigin(def);
+                    }
+                    continue;
+                }
+            } else if (F.followPath) {
+                if (F.nextOperand < F.defs.size()) {
+                    checkBeforeTrace(cast<Instruction>(F.defs[F.nextOperand++]));
+                    continue;
+                }
+            } else if (auto *U = dyn_cast<User>(F.V)) {
+                if (F.nextOperand < U->getNumOperands()) {
+                    traceVariableOrigin(U->getOperand(F.nextOperand++));
+                    continue;
+                }
+            }
+            popFrame();
+        }
+        return workStack[0].sources;
+    }
+
+    void recordBranch(Instruction *br, const SourceSet &found) {
+        Report.branches.push_back(makeFinding(br, found.getArrayRef(), truncated, moduleInfo));
+        const SmallVector<CallInst*, 4> &Sources = Report.branches.back().Sources;
+        if (!verbose || !FuzzDir.empty()) {
+            Report.records.push_back(makeBranchRecord(Report.branches.back(), moduleInfo));
+        }
+        if (!verbose) {
+            return;
+        }
+        if (truncated) {
+            OS << "Exploration budget exceeded, trace truncated at branch: " << *br << "\n";
+        }
+        if (Sources.empty()) {
+            return;
+        }
+        OS << "Seminal inputs reaching branch: " << *br << "\n";
+        for (CallInst *source : Sources) {
+            OS << "\t  " << *source << "\n";
+        }
+    }
+
+    void traceFunction(Function &F) {
+        if (F.isDeclaration() || !moduleInfo.query.selects(F)) {
+            return;
+        }
+        currentFunction = &F;
+        TimeTraceScope timeScope("SeminalTraceFunction", F.getName());
+        functionValues = 0;
+        functionStart = Clock::now();
+        stepsSinceClockCheck = 0;
+        outOfTime = false;
+        // errs() << "I see a function called " << F.getName() << "\n";
+
+        for (auto &BB : F) {
+        //   errs() << "I see a basic block " << BB.getName() << "\n";
+          for (auto &I : BB) {
+
+            // errs() << "analyzing uses of: " << I << "\n";
+            
+            // Conditional branches and the instructions selected by
+            // -seminal-control-flow share the summaries of the function
+            if (Value *condition = getDecidingValue(I)) {
+                if (moduleInfo.query.selects(&I)) {
+                    // errs() << "branch instruction condition: " << condition << "\n";
+                    // checkBeforeTrace(condition);
+                    ++NumBranchesTraced;
+                    recordBranch(&I, traceCondition(condition));
+                }
+            }
+          }
+        }
+
+        // The summaries are only reused within the function, so peak memory is
+        // bounded by the largest function rather than the whole module
+        graph.clear();
+        nextTraceIndex = 0;
+    }
+};
+
+static cl::opt<bool> DataflowMode("seminal-dataflow",
+    cl::desc("Propagate seminal input bit vectors over each function instead of tracing branch by branch"),
+    cl::init(false));
+
+static cl::opt<bool> CondenseMode("seminal-condense",
+    cl::desc("Collapse def-use cycles before propagating, so each cycle is processed once (implies -seminal-dataflow)"),
+    cl::init(false));
+
+// Whole-function formulation of the trace. The values reachable from the
+// branch conditions of a function form the graph SeminalTracer walks; every
+// seminal input in it gets a bit, and the bit vectors flow from each value's
+// trace successors to the value until nothing changes. All the branches of
+// the function are then read off at once. There is no step by step trace.
+class DataflowTracer {
+public:
+    DataflowTracer(const ModuleInfo &moduleInfo, SeminalReport &Report, bool verbose)
+        : moduleInfo(moduleInfo), Report(Report), OS(Report.trace), verbose(verbose) {}
+
+    void traceFunction(Function &F) {
+        if (F.isDeclaration() || !moduleInfo.query.selects(F)) {
+            return;
+        }
+        TimeTraceScope timeScope("SeminalDataflowFunction", F.getName());
+        currentFunction = &F;
+
+        SmallVector<Instruction*, 16> branches;
+        for (Instruction &I : instructions(F)) {
+            if (getDecidingValue(I) && moduleInfo.query.selects(&I)) {
+                branches.push_back(&I);
+            }
+        }
+        std::vector<unsigned> order = buildGraph(branches);
+        if (CondenseMode) {
+            propagateCondensed();
+        } else {
+            propagate(order);
+        }
+
+        for (Instruction *br : branches) {
+            ++NumBranchesTraced;
+            SmallVector<CallInst*, 4> found;
+            Value *condition = getDecidingValue(*br);
+            auto It = nodeOf.find(condition);
+            if (It != nodeOf.end()) {
+                for (unsigned bit : taint[componentOf[It->second]].set_bits()) {
+                    found.push_back(sources[bit]);
+                }
+            }
+            if (const SourceSet *callSources = moduleInfo.lookupCallSources(condition)) {
+                for (CallInst *source : *callSources) {
+                    if (!is_contained(found, source)) {
+                        found.push_back(source);
+                    }
+                }
+            }
+            recordBranch(br, found);
+        }
+
+        nodeOf.clear();
+        nodes.clear();
+        succStart.clear();
+        succValues.clear();
+        succIds.clear();
+        taint.clear();
+        componentOf.clear();
+        genStart.clear();
+        genSources.clear();
+        bitOf.clear();
+        sources.clear();
+    }
+
+private:
+    const ModuleInfo &moduleInfo;
+    SeminalReport &Report;
+    raw_string_ostream OS;
+    bool verbose;
+    Function *currentFunction = nullptr;
+
+    // Graph of the current function. The successors and the seminal inputs
+    // of node i are entries [succStart[i], succStart[i + 1]) of succIds and
+    // [genStart[i], genStart[i + 1]) of genSources.
+    DenseMap<Value*, unsigned> nodeOf;
+    std::vector<Value*> nodes;
+    std::vector<unsigned> succStart;
+    std::vector<Value*> succValues;
+    std::vector<unsigned> succIds;
+    std::vector<unsigned> genStart;
+    std::vector<CallInst*> genSources;
+
+    // Seminal inputs of each component, the SCC of a node with
+    // -seminal-condense and the node itself otherwise
+    std::vector<unsigned> componentOf;
+    std::vector<BitVector> taint;
+
+    // Bit of each seminal input
+    DenseMap<CallInst*, unsigned> bitOf;
+    std::vector<CallInst*> sources;
+
+    static bool isTraceable(Value *V) {
+        AccessPath path;
+        return isa<Argument>(V) || isa<Instruction>(V) || isa<GlobalVariable>(V) ||
+               (isa<ConstantExpr>(V) && getAccessPath(V, path));
+    }
+
+    // The values SeminalTracer continues with from V, and the seminal inputs
+    // V adds by itself
+    void expand(Value *V) {
+        // An operand or reaching definition; users are added by addUsers
+        auto addSucc = [&](Value *S) {
+            if (isTraceable(S)) {
+                succValues.push_back(S);
+            }
+            if (const SourceSet *callSources = moduleInfo.lookupCallSources(S)) {
+                genSources.insert(genSources.end(), callSources->begin(), callSources->end());
+            }
+        };
+        auto addUsers = [&](Value *V) {
+            for (User *U : V->users()) {
+                if (isa<Instruction>(U)) {
+                    succValues.push_back(U);
+                }
+            }
+        };
+
+        AccessPath path;
+        if (getAccessPath(V, path)) {
+            SmallVector<Value*, 8> users;
+            collectPathUsers(path, users);
+            succValues.insert(succValues.end(), users.begin(), users.end());
+            if (auto *GV = dyn_cast<GlobalVariable>(path.base)) {
+                Report.visitedGlobals.insert(GV);
+            } else if (auto *arg = dyn_cast<Argument>(path.base)) {
+                if (const FunctionSummary *summary = moduleInfo.lookupSummary(arg->getParent())) {
+                    const SourceSet &argSources = summary->argSources[arg->getArgNo()];
+                    genSources.insert(genSources.end(), argSources.begin(), argSources.end());
+                }
+            }
+        } else if (auto *arg = dyn_cast<Argument>(V)) {
+            if (!SSAMode || arg->getType()->isPointerTy()) {
+                addUsers(arg);
+            }
+            if (const FunctionSummary *summary = moduleInfo.lookupSummary(arg->getParent())) {
+                const SourceSet &argSources = summary->argSources[arg->getArgNo()];
+                genSources.insert(genSources.end(), argSources.begin(), argSources.end());
+            }
+        } else if (auto *GV = dyn_cast<GlobalVariable>(V)) {
+            SourceSet found;
+            if (moduleInfo.useGlobalSummary(GV, Report, found)) {
+                genSources.insert(genSources.end(), found.begin(), found.end());
+            } else {
+                addUsers(GV);
+            }
+        } else if (isa<AllocaInst>(V)) {
+            addUsers(V);
+        } else if (auto *I = dyn_cast<Instruction>(V)) {
+            auto *callInst = dyn_cast<CallInst>(I);
+            if (Function *callee = callInst ? callInst->getCalledFunction() : nullptr) {
+                if (moduleInfo.sources.lookup(callee) || moduleInfo.isExternalCall(callee)) {
+                    genSources.push_back(callInst);
+                }
+                if (const FunctionSummary *summary = moduleInfo.lookupSummary(callee)) {
+                    genSources.insert(genSources.end(), summary->outSources.begin(), summary->outSources.end());
+                }
+            }
+
+            auto *load = dyn_cast<LoadInst>(I);
+            MemorySSA *MSSA = load && load->getFunction() == currentFunction
+                ? moduleInfo.memorySSA.lookup(currentFunction) : nullptr;
+            if (MSSA) {
+                SmallVector<Value*, 4> defs;
+                SeminalTracer::collectReachingDefs(load, *MSSA, defs);
+                for (Value *def : defs) {
+                    auto *store = dyn_cast<StoreInst>(def);
+                    addSucc(store ? store->getValueOperand() : def);
+                }
+            } else {
+                for (Value *operand : I->operands()) {
+                    addSucc(operand);
+                }
+            }
+        }
+    }
+
+    unsigned addNode(Value *V) {
+        unsigned id = nodes.size();
+        nodeOf[V] = id;
+        nodes.push_back(V);
+        expand(V);
+        succStart.push_back(succValues.size());
+        genStart.push_back(genSources.size());
+
+        Report.visitedValues++;
+        ++NumValuesTraced;
+        if (auto *I = dyn_cast<Instruction>(V)) {
+            Report.visitedFunctions.insert(I->getFunction());
+        } else if (auto *A = dyn_cast<Argument>(V)) {
+            Report.visitedFunctions.insert(A->getParent());
+        } else if (auto *GV = dyn_cast<GlobalVariable>(V)) {
+            Report.visitedGlobals.insert(GV);
+        }
+        return id;
+    }
+
+    // Discover the nodes reachable from the branch conditions, returning them
+    // in post-order so that successors mostly come before their users
+    std::vector<unsigned> buildGraph(ArrayRef<Instruction*> branches) {
+        succStart.push_back(0);
+        genStart.push_back(0);
+        std::vector<unsigned> order;
+        std::vector<std::pair<unsigned, unsigned>> stack;  // node, next successor
+        auto visit = [&](Value *V) {
+            if (nodeOf.count(V)) {
+                return;
+            }
+            stack.push_back({addNode(V), 0});
+            while (!stack.empty()) {
+                auto &[node, next] = stack.back();
+                if (succStart[node] + next < succStart[node + 1]) {
+                    Value *S = succValues[succStart[node] + next++];
+                    if (!nodeOf.count(S)) {
+                        stack.push_back({addNode(S), 0});
+                    }
+                    continue;
+                }
+                order.push_back(node);
+                stack.pop_back();
+            }
+        };
+        for (Instruction *br : branches) {
+            Value *condition = getDecidingValue(*br);
+            if (isTraceable(condition)) {
+                visit(condition);
+            }
+        }
+
+        succIds.reserve(succValues.size());
+        for (Value *S : succValues) {
+            succIds.push_back(nodeOf.lookup(S));
+        }
+        for (CallInst *source : genSources) {
+            if (bitOf.try_emplace(source, sources.size()).second) {
+                sources.push_back(source);
+                ++NumSeminalInputs;
+            }
+        }
+        return order;
+    }
+
+    void propagate(ArrayRef<unsigned> order) {
+        componentOf.resize(nodes.size());
+        std::iota(componentOf.begin(), componentOf.end(), 0);
+        taint.assign(nodes.size(), BitVector(sources.size()));
+        for (unsigned node = 0; node < nodes.size(); node++) {
+            for (unsigned i = genStart[node]; i < genStart[node + 1]; i++) {
+                taint[node].set(bitOf.lookup(genSources[i]));
+            }
+        }
+
+        // Only values on def-use cycles need more than one sweep
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (unsigned node : order) {
+                BitVector &bits = taint[node];
+                unsigned before = bits.count();
+                for (unsigned i = succStart[node]; i < succStart[node + 1]; i++) {
+                    bits |= taint[succIds[i]];
+                }
+                changed |= bits.count() != before;
+            }
+        }
+    }
+
+    // Number the SCCs of the graph with Tarjan's algorithm. A component is
+    // numbered after every component it reaches, so one pass in numbering
+    // order propagates the seminal inputs over the condensed graph.
+    void propagateCondensed() {
+        const unsigned Unvisited = ~0u;
+        unsigned numNodes = nodes.size();
+        std::vector<unsigned> index(numNodes, Unvisited), low(numNodes);
+        std::vector<bool> onStack(numNodes);
+        std::vector<unsigned> sccStack;
+        std::vector<std::pair<unsigned, unsigned>> stack;  // node, next successor
+        unsigned nextIndex = 0, numComponents = 0;
+        componentOf.assign(numNodes, 0);
+
+        auto enter = [&](unsigned node) {
+            index[node] = low[node] = nextIndex++;
+            sccStack.push_back(node);
+            onStack[node] = true;
+            stack.push_back({node, 0});
+        };
+        for (unsigned root = 0; root < numNodes; root++) {
+            if (index[root] != Unvisited) {
+                continue;
+            }
+            enter(root);
+            while (!stack.empty()) {
+                auto &[node, next] = stack.back();
+                if (succStart[node] + next < succStart[node + 1]) {
+                    unsigned succ = succIds[succStart[node] + next++];
+                    if (index[succ] == Unvisited) {
+                        enter(succ);
+                    } else if (onStack[succ]) {
+                        low[node] = std::min(low[node], index[succ]);
+                    }
+                    continue;
+                }
+
+                unsigned done = node;
+                if (low[done] == index[done]) {
+                    unsigned member, size = 0;
+                    do {
+                        member = sccStack.back();
+                        sccStack.pop_back();
+                        onStack[member] = false;
+                        componentOf[member] = numComponents;
+                        size++;
+                    } while (member != done);
+                    if (size > 1) {
+                        ++NumCycleComponents;
+                    }
+                    numComponents++;
+                }
+                stack.pop_back();
+                if (!stack.empty()) {
+                    unsigned parent = stack.back().first;
+                    low[parent] = std::min(low[parent], low[done]);
+                }
+            }
+        }
+
+        // Group the nodes by component, then propagate once in numbering order
+        std::vector<unsigned> memberStart(numComponents + 1), members(numNodes);
+        for (unsigned node = 0; node < numNodes; node++) {
+            memberStart[componentOf[node] + 1]++;
+        }
+        std::partial_sum(memberStart.begin(), memberStart.end(), memberStart.begin());
+        std::vector<unsigned> fill(memberStart.begin(), memberStart.end() - 1);
+        for (unsigned node = 0; node < numNodes; node++) {
+            members[fill[componentOf[node]]++] = node;
+        }
+
+        taint.assign(numComponents, BitVector(sources.size()));
+        for (unsigned component = 0; component < numComponents; component++) {
+            BitVector &bits = taint[component];
+            for (unsigned i = memberStart[component]; i < memberStart[component + 1]; i++) {
+                unsigned node = members[i];
+                for (unsigned j = genStart[node]; j < genStart[node + 1]; j++) {
+                    bits.set(bitOf.lookup(genSources[j]));
+                }
+                for (unsigned j = succStart[node]; j < succStart[node + 1]; j++) {
+                    unsigned succComponent = componentOf[succIds[j]];
+                    if (succComponent != component) {
+                        bits |= taint[succComponent];
+                    }
+                }
+            }
+        }
+    }
+
+    void recordBranch(Instruction *br, ArrayRef<CallInst*> found) {
+        Report.branches.push_back(makeFinding(br, found, false, moduleInfo));
+        const SmallVector<CallInst*, 4> &Sources = Report.branches.back().Sources;
+        if (!verbose || !FuzzDir.empty()) {
+            Report.records.push_back(makeBranchRecord(Report.branches.back(), moduleInfo));
+        }
+        if (!verbose) {
+            return;
+        }
+        if (Sources.empty()) {
+            return;
+        }
+        OS << "Seminal inputs reaching branch: " << *br << "\n";
+        for (CallInst *source : Sources) {
+            OS << "\t  " << *source << "\n";
+        }
+    }
+};
+
+// Trace the branches of some functions into one report
+static void traceInto(SeminalReport &report, ArrayRef<Function*> functions, const ModuleInfo &moduleInfo, bool verbose) {
+    if (DataflowMode || CondenseMode) {
+        DataflowTracer tracer(moduleInfo, report, verbose);
+        for (Function *F : functions) {
+            tracer.traceFunction(*F);
+        }
+        return;
+    }
+    SeminalTracer tracer(moduleInfo, report, verbose);
+    for (Function *F : functions) {
+        tracer.traceFunction(*F);
+    }
+}
+
+// Returns true if a pointer is derived from one of its function's arguments,
+// following casts, GEPs, phis and the stores to allocas it is loaded from
+static bool derivesFromArgument(Value *Ptr) {
+    SmallVector<Value*, 8> worklist = {Ptr};
+    SmallPtrSet<Value*, 8> visited;
+    while (!worklist.empty()) {
+        Value *V = worklist.pop_back_val();
+        if (!visited.insert(V).second) {
+            continue;
+        }
+        if (isa<Argument>(V)) {
+            return true;
+        }
+        if (auto *load = dyn_cast<LoadInst>(V)) {
+            if (auto *slot = dyn_cast<AllocaInst>(load->getPointerOperand())) {
+                for (User *U : slot->users()) {
+                    auto *store = dyn_cast<StoreInst>(U);
+                    if (store && store->getPointerOperand() == slot) {
+                        worklist.push_back(store->getValueOperand());
+                    }
+                }
+            }
+        } else if (auto *gep = dyn_cast<GetElementPtrInst>(V)) {
+            worklist.push_back(gep->getPointerOperand());
+        } else if (auto *castInst = dyn_cast<CastInst>(V)) {
+            worklist.push_back(castInst->getOperand(0));
+        } else if (isa<PHINode>(V) || isa<SelectInst>(V)) {
+            for (Value *incoming : cast<Instruction>(V)->operands()) {
+                worklist.push_back(incoming);
+            }
+        }
+    }
+    return false;
+}
+
+static cl::opt<bool> PhaseStats("seminal-phase-stats",
+    cl::desc("Print the time, peak memory and traced values of each phase of the pass"),
+    cl::init(false));
+
+// Wall time, peak memory and number of values traced by the phases of one
+// run of the pass, printed as JSON lines on stderr with -seminal-phase-stats
+class PhaseStatistics {
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        std::string name;
+        double seconds;
+        size_t visitedValues;
+        long peakRSS;  // kilobytes
+    };
+    std::vector<Phase> phases;
+    Clock::time_point start = Clock::now();
+
+public:
+    void startPhase() {
+        start = Clock::now();
+    }
+
+    void endPhase(StringRef name, size_t visitedValues = 0) {
+        Clock::time_point end = Clock::now();
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        phases.push_back({name.str(), std::chrono::duration<double>(end - start).count(),
+                          visitedValues, usage.ru_maxrss});
+        start = Clock::now();
+    }
+
+    void print(const Module &M) const {
+        for (const Phase &phase : phases) {
+            json::OStream J(errs());
+            J.object([&] {
+                J.attribute("module", M.getSourceFileName());
+                J.attribute("phase", phase.name);
+                J.attribute("seconds", phase.seconds);
+                J.attribute("visited_values", int64_t(phase.visitedValues));
+                J.attribute("peak_rss_kb", int64_t(phase.peakRSS));
+            });
+            errs() << "\n";
+        }
+    }
+};
+
+// Compute the interprocedural summaries of the module's functions. Call
+// summaries are computed bottom-up over the call graph SCCs, so a function's
+// callees are summarized before it; argument summaries top-down, so every
+// caller is done before its callees. Functions of a recursive SCC are
+// revisited until their summaries stop growing. Each function is traced once
+// per visit, with every summary computed so far.
+static size_t computeSummaries(Module &M, ModuleInfo &moduleInfo) {
+    TimeTraceScope timeScope("SeminalSummaries", M.getSourceFileName());
+    size_t visitedValues = 0;
+    std::vector<std::vector<Function*>> sccs;
+    CallGraph CG(M);
+    for (scc_iterator<CallGraph*> I = scc_begin(&CG); !I.isAtEnd(); ++I) {
+        std::vector<Function*> scc;
+        for (CallGraphNode *node : *I) {
+            Function *F = node->getFunction();
+            if (F && !F->isDeclaration()) {
+                scc.push_back(F);
+                moduleInfo.summaries[F].argSources.resize(F->arg_size());
+            }
+        }
+        if (!scc.empty()) {
+            sccs.push_back(std::move(scc));
+        }
+    }
+
+    auto merge = [](SourceSet &into, const SourceSet &from) {
+        size_t size = into.size();
+        into.insert(from.begin(), from.end());
+        return into.size() != size;
+    };
+
+    for (const std::vector<Function*> &scc : sccs) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (Function *F : scc) {
+                FunctionSummary &summary = moduleInfo.summaries[F];
+
+                // Seminal inputs, and calls storing seminal inputs, writing
+                // through a pointer derived from an argument
+                for (Instruction &I : instructions(F)) {
+                    auto *callInst = dyn_cast<CallInst>(&I);
+                    Function *callee = callInst ? callInst->getCalledFunction() : nullptr;
+                    if (!callee) {
+                        continue;
+                    }
+                    const FunctionSummary *calleeSummary = moduleInfo.lookupSummary(callee);
+                    bool isSeminal = moduleInfo.sources.lookup(callee) || moduleInfo.isExternalCall(callee);
+                    if (!isSeminal && (!calleeSummary || calleeSummary->outSources.empty())) {
+                        continue;
+                    }
+                    for (Value *arg : callInst->args()) {
+                        if (arg->getType()->isPointerTy() && derivesFromArgument(arg)) {
+                            if (isSeminal) {
+                                changed |= summary.outSources.insert(callInst);
+                            } else {
+                                changed |= merge(summary.outSources, calleeSummary->outSources);
+                            }
+                            break;
+                        }
+                    }
+                }
+
+                SeminalReport scratch;
+                SeminalTracer tracer(moduleInfo, scratch, /*verbose=*/false);
+                tracer.currentFunction = F;
+                SourceSet callSources = summary.outSources;
+                for (Instruction &I : instructions(F)) {
+                    if (auto *ret = dyn_cast<ReturnInst>(&I)) {
+                        if (Value *retVal = ret->getReturnValue()) {
+                            const SourceSet &retSources = tracer.traceCondition(retVal);
+                            callSources.insert(retSources.begin(), retSources.end());
+                        }
+                    }
+                }
+                changed |= merge(summary.callSources, callSources);
+                visitedValues += scratch.visitedValues;
+            }
+        }
+    }
+
+    for (const std::vector<Function*> &scc : reverse(sccs)) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (Function *F : scc) {
+                SeminalReport scratch;
+                SeminalTracer tracer(moduleInfo, scratch, /*verbose=*/false);
+                tracer.currentFunction = F;
+                for (Instruction &I : instructions(F)) {
+                    auto *callInst = dyn_cast<CallInst>(&I);
+                    Function *callee = callInst ? callInst->getCalledFunction() : nullptr;
+                    if (!callee || callee->isDeclaration()) {
+                        continue;
+                    }
+                    for (unsigned i = 0; i < callee->arg_size() && i < callInst->arg_size(); i++) {
+                        SourceSet actualSources = tracer.traceCondition(callInst->getArgOperand(i));
+                        changed |= merge(moduleInfo.summaries[callee].argSources[i], actualSources);
+                    }
+                }
+                visitedValues += scratch.visitedValues;
+            }
+        }
+    }
+    return visitedValues;
+}
+
+// Sources reaching each global variable through all of its users, traced
+// once per module instead of again by every function whose trace reaches
+// the global. Where the walk of a global starts does not matter, except for
+// the MemorySSA queries of the function being traced, so the summaries are
+// not used with -seminal-memoryssa; the text trace shows every step and does
+// not use them either. Globals whose walk runs out of budget are left out.
+static size_t computeGlobalSummaries(Module &M, ModuleInfo &moduleInfo) {
+    TimeTraceScope timeScope("SeminalGlobalSummaries", M.getSourceFileName());
+    size_t visitedValues = 0;
+    for (GlobalVariable &GV : M.globals()) {
+        if (GV.use_empty()) {
+            continue;
+        }
+        // Later globals reuse the summaries of the earlier ones
+        SeminalReport scratch;
+        SeminalTracer tracer(moduleInfo, scratch, /*verbose=*/false);
+        const SourceSet &found = tracer.traceCondition(&GV);
+        visitedValues += scratch.visitedValues;
+        if (tracer.truncated) {
+            continue;
+        }
+        GlobalSummary &summary = moduleInfo.globalSummaries[&GV];
+        summary.sources = found;
+        summary.functions = std::move(scratch.visitedFunctions);
+        summary.globals = std::move(scratch.visitedGlobals);
+    }
+    return visitedValues;
+}
+
+// Quote a CSV field if it contains a separator, quote or newline
+static void writeCSVField(raw_ostream &OS, StringRef field) {
+    if (field.find_first_of(",\"\n") == StringRef::npos) {
+        OS << field;
+        return;
+    }
+    OS << '"';
+    for (char c : field) {
+        if (c == '"') {
+            OS << '"';
+        }
+        OS << c;
+    }
+    OS << '"';
+}
+
+static void writeJSONLines(raw_ostream &OS, ArrayRef<SeminalReport> reports) {
+    unsigned id = 0;
+    for (const SeminalReport &report : reports) {
+        for (const BranchRecord &branch : report.records) {
+            json::OStream J(OS);
+            J.object([&] {
+                J.attribute("id", branch.id.value_or(id));
+                id++;
+                J.attribute("function", branch.function);
+                J.attribute("file", branch.loc.file);
+                J.attribute("line", branch.loc.line);
+                J.attribute("column", branch.loc.col);
+                J.attribute("kind", branch.kind);
+                J.attribute("truncated", branch.truncated);
+                J.attributeArray("sources", [&] {
+                    for (const SourceRecord &source : branch.sources) {
+                        J.object([&] {
+                            J.attribute("callee", source.callee);
+                            J.attribute("function", source.function);
+                            J.attribute("file", source.loc.file);
+                            J.attribute("line", source.loc.line);
+                            J.attribute("column", source.loc.col);
+                        });
+                    }
+                });
+            });
+            OS << "\n";
+        }
+    }
+}
+
+// One row per branch and seminal input; branches without any seminal input
+// get a single row with empty source columns
+static void writeCSV(raw_ostream &OS, ArrayRef<SeminalReport> reports) {
+    OS << "branch_id,function,file,line,column,source_callee,source_function,source_file,source_line,source_column,truncated,kind\n";
+    unsigned id = 0;
+    for (const SeminalReport &report : reports) {
+        for (const BranchRecord &branch : report.records) {
+            auto writeBranch = [&] {
+                OS << branch.id.value_or(id) << ",";
+                writeCSVField(OS, branch.function);
+                OS << ",";
+                writeCSVField(OS, branch.loc.file);
+                OS << "," << branch.loc.line << "," << branch.loc.col << ",";
+            };
+            for (const SourceRecord &source : branch.sources) {
+                writeBranch();
+                writeCSVField(OS, source.callee);
+                OS << ",";
+                writeCSVField(OS, source.function);
+                OS << ",";
+                writeCSVField(OS, source.loc.file);
+                OS << "," << source.loc.line << "," << source.loc.col << "," << branch.truncated << "," << branch.kind << "\n";
+            }
+            if (branch.sources.empty()) {
+                writeBranch();
+                OS << ",,,,," << branch.truncated << "," << branch.kind << "\n";
+            }
+            id++;
+        }
+    }
+}
+
+// Sort keys of the summary report, in source order
+using SourceKey = std::tuple<std::string, unsigned, unsigned, std::string, std::string>;  // file, line, column, function, callee
+using BranchKey = std::tuple<std::string, unsigned, unsigned, std::string, unsigned, std::string>;  // file, line, column, function, ordinal, kind
+
+static void writeSourceKey(raw_ostream &OS, const SourceKey &key) {
+    const auto &[file, line, col, function, callee] = key;
+    OS << callee << " in " << function;
+    if (line) {
+        OS << " at " << file << ":" << line << ":" << col;
+    }
+}
+
+static void writeBranchKey(raw_ostream &OS, const BranchKey &key, bool truncated) {
+    const auto &[file, line, col, function, ordinal, kind] = key;
+    OS << function;
+    if (line) {
+        if (kind != "branch") {
+            OS << " " << kind;
+        }
+        OS << " at " << file << ":" << line << ":" << col;
+    } else {
+        OS << " " << kind << " #" << ordinal;
+    }
+    if (truncated) {
+        OS << " (truncated)";
+    }
+}
+
+// Every seminal input call site with the branches it reaches, then every
+// branch with the seminal inputs reaching it, each listed once and in source
+// order. Branches without a location are numbered within their function.
+static void writeSummary(raw_ostream &OS, ArrayRef<SeminalReport> reports) {
+    std::map<SourceKey, std::set<BranchKey>> branchesOf;
+    std::map<BranchKey, std::set<SourceKey>> sourcesOf;
+    std::set<BranchKey> truncated;
+    unsigned numBranches = 0;
+
+    StringMap<unsigned> ordinals;
+    for (const SeminalReport &report : reports) {
+        for (const BranchRecord &branch : report.records) {
+            numBranches++;
+            unsigned ordinal = ordinals[branch.function]++;
+            BranchKey branchKey{branch.loc.file, branch.loc.line, branch.loc.col, branch.function,
+                                branch.loc.line ? 0 : ordinal, branch.kind};
+            if (branch.truncated) {
+                truncated.insert(branchKey);
+            }
+            for (const SourceRecord &source : branch.sources) {
+                SourceKey sourceKey{source.loc.file, source.loc.line, source.loc.col, source.function, source.callee};
+                branchesOf[sourceKey].insert(branchKey);
+                sourcesOf[branchKey].insert(sourceKey);
+            }
+        }
+    }
+
+    OS << "Seminal inputs: " << branchesOf.size() << ", branches reached: " << sourcesOf.size()
+       << " of " << numBranches << "\n";
+    for (const auto &[source, branches] : branchesOf) {
+        OS << "Seminal input ";
+        writeSourceKey(OS, source);
+        OS << "\n";
+        for (const BranchKey &branch : branches) {
+            OS << "\tBranch ";
+            writeBranchKey(OS, branch, truncated.count(branch));
+            OS << "\n";
+        }
+    }
+    for (const auto &[branch, sources] : sourcesOf) {
+        OS << "Branch ";
+        writeBranchKey(OS, branch, truncated.count(branch));
+        OS << "\n";
+        for (const SourceKey &source : sources) {
+            OS << "\tSeminal input ";
+            writeSourceKey(OS, source);
+            OS << "\n";
+        }
+    }
+}
+
+// The tables of seminal_report.h. Strings and seminal input call sites are
+// stored once and referred to by offset and index. Call sites are told apart
+// by their call instruction, so calls without debug info stay distinct; the
+// records of a cached function have none and are told apart by location.
+static void writeBinary(raw_ostream &OS, const Module &M, ArrayRef<SeminalReport> reports) {
+    namespace report = seminal::report;
+    std::string strings(1, '\0');
+    StringMap<uint32_t> stringOffsets;
+    auto addString = [&](StringRef value) -> uint32_t {
+        if (value.empty()) {
+            return 0;
+        }
+        auto [It, inserted] = stringOffsets.try_emplace(value, strings.size());
+        if (inserted) {
+            strings.append(value.data(), value.size());
+            strings.push_back('\0');
+        }
+        return It->second;
+    };
+
+    std::vector<report::Branch> branches;
+    std::vector<report::Source> sources;
+    std::vector<uint32_t> edges;
+    DenseMap<const CallInst*, uint32_t> callIndex;
+    std::map<SourceKey, uint32_t> sourceIndex;
+    unsigned id = 0;
+    for (const SeminalReport &functionReport : reports) {
+        bool hasFindings = functionReport.branches.size() == functionReport.records.size();
+        for (size_t i = 0; i < functionReport.records.size(); i++) {
+            const BranchRecord &branch = functionReport.records[i];
+            report::Branch b;
+            b.id = branch.id.value_or(id);
+            id++;
+            b.function = addString(branch.function);
+            b.file = addString(branch.loc.file);
+            b.line = branch.loc.line;
+            b.column = branch.loc.col;
+            b.kind = StringSwitch<uint32_t>(branch.kind)
+                         .Case("switch", report::KindSwitch)
+                         .Case("select", report::KindSelect)
+                         .Case("indirectbr", report::KindIndirectBr)
+                         .Default(report::KindBranch);
+            b.flags = branch.truncated ? report::FlagTruncated : 0;
+            b.firstEdge = edges.size();
+            for (size_t j = 0; j < branch.sources.size(); j++) {
+                const SourceRecord &source = branch.sources[j];
+                uint32_t index = sources.size();
+                bool inserted;
+                if (hasFindings) {
+                    auto It = callIndex.try_emplace(functionReport.branches[i].Sources[j], index);
+                    index = It.first->second;
+                    inserted = It.second;
+                } else {
+                    SourceKey key{source.loc.file, source.loc.line, source.loc.col, source.function, source.callee};
+                    auto It = sourceIndex.try_emplace(key, index);
+                    index = It.first->second;
+                    inserted = It.second;
+                }
+                if (inserted) {
+                    sources.push_back({addString(source.callee), addString(source.function),
+                                       addString(source.loc.file), source.loc.line, source.loc.col});
+                }
+                if (!is_contained(makeArrayRef(edges).drop_front(b.firstEdge), index)) {
+                    edges.push_back(index);
+                }
+            }
+            b.numEdges = edges.size() - b.firstEdge;
+            branches.push_back(b);
+        }
+    }
+
+    report::Header header{report::Magic, report::Version, addString(M.getSourceFileName()),
+                          uint32_t(branches.size()), uint32_t(sources.size()), uint32_t(edges.size()),
+                          0, 0};
+    header.stringsSize = strings.size();
+
+    // Every record is a run of u32 fields
+    auto writeFields = [&](const void *record, size_t size) {
+        const uint32_t *fields = static_cast<const uint32_t*>(record);
+        for (size_t i = 0; i < size / 4; i++) {
+            char bytes[4];
+            support::endian::write32le(bytes, fields[i]);
+            OS.write(bytes, 4);
+        }
+    };
+    writeFields(&header, sizeof(header));
+    for (const report::Branch &b : branches) {
+        writeFields(&b, sizeof(b));
+    }
+    for (const report::Source &source : sources) {
+        writeFields(&source, sizeof(source));
+    }
+    writeFields(edges.data(), edges.size() * 4);
+    OS << strings;
+}
+
+// Write all reports of a module at once through a single buffered stream
+static void writeReports(raw_ostream &OS, const Module &M, ArrayRef<SeminalReport> reports) {
+    TimeTraceScope timeScope("SeminalWriteReports");
+    switch (ReportFormatOpt) {
+    case ReportFormat::Text:
+        for (const SeminalReport &report : reports) {
+            OS << report.trace;
+        }
+        break;
+    case ReportFormat::JSONLines:
+        writeJSONLines(OS, reports);
+        break;
+    case ReportFormat::CSV:
+        writeCSV(OS, reports);
+        break;
+    case ReportFormat::Summary:
+        writeSummary(OS, reports);
+        break;
+    case ReportFormat::Binary:
+        writeBinary(OS, M, reports);
+        break;
+    }
+    OS.flush();
+}
+
+// Write the reports to -seminal-report-file, or to stderr
+static void writeReports(const Module &M, ArrayRef<SeminalReport> reports) {
+    bool binary = ReportFormatOpt == ReportFormat::Binary;
+    if (binary && ReportFile.empty()) {
+        return;  // reported by SkeletonPass::run
+    }
+    std::unique_ptr<raw_fd_ostream> file;
+    if (!ReportFile.empty()) {
+        std::error_code EC;
+        file = std::make_unique<raw_fd_ostream>(ReportFile, EC, binary ? sys::fs::OF_None : sys::fs::OF_Text);
+        if (EC) {
+            errs() << "error: cannot open seminal input report '" << ReportFile << "': " << EC.message() << "\n";
+            return;
+        }
+    }
+    raw_fd_ostream stderrStream(STDERR_FILENO, /*shouldClose=*/false);
+    writeReports(file ? *file : stderrStream, M, reports);
+}
+
+static cl::opt<std::string> CacheDir("seminal-cache-dir",
+    cl::desc("Reuse the findings of unchanged functions cached in this directory (jsonl and csv reports)"),
+    cl::value_desc("directory"), cl::init(""));
+
+static void writeHashOperand(raw_ostream &OS, const Value *V, const DenseMap<const Value*, unsigned> &numbering) {
+    auto It = numbering.find(V);
+    if (It != numbering.end()) {
+        OS << '%' << It->second;
+    } else if (auto *A = dyn_cast<Argument>(V)) {
+        OS << 'a' << A->getArgNo();
+    } else if (auto *GV = dyn_cast<GlobalValue>(V)) {
+        OS << '@' << GV->getName() << ';';
+    } else if (auto *CI = dyn_cast<ConstantInt>(V)) {
+        OS << 'c' << CI->getValue() << ';';
+    } else if (auto *CE = dyn_cast<ConstantExpr>(V)) {
+        OS << 'e' << CE->getOpcode() << '(';
+        for (const Use &U : CE->operands()) {
+            writeHashOperand(OS, U.get(), numbering);
+        }
+        OS << ')';
+    } else {
+        OS << 'k' << V->getValueID();
+    }
+}
+
+// Stable hash of everything in a function that can change its findings: the
+// instructions and their operands, callee and global names, and the debug
+// locations written to the report
+static uint64_t hashFunction(const Function &F) {
+    DenseMap<const Value*, unsigned> numbering;
+    for (const BasicBlock &BB : F) {
+        numbering[&BB] = numbering.size();
+        for (const Instruction &I : BB) {
+            numbering[&I] = numbering.size();
+        }
+    }
+
+    SmallString<1024> buffer;
+    raw_svector_ostream OS(buffer);
+    OS << F.getName() << '(' << F.arg_size() << ')';
+    for (const BasicBlock &BB : F) {
+        OS << 'B';
+        for (const Instruction &I : BB) {
+            OS << 'I' << I.getOpcode() << ':' << I.getType()->getTypeID();
+            if (auto *Cmp = dyn_cast<CmpInst>(&I)) {
+                OS << 'p' << Cmp->getPredicate();
+            }
+            for (const Use &U : I.operands()) {
+                writeHashOperand(OS, U.get(), numbering);
+            }
+            if (const DebugLoc &debugLoc = I.getDebugLoc()) {
+                auto *scope = debugLoc->getScope();
+                OS << '!' << debugLoc.getLine() << ':' << debugLoc.getCol() << ':'
+                   << scope->getDirectory() << '/' << scope->getFilename() << ';';
+            }
+        }
+    }
+    return xxHash64(buffer);
+}
+
+// A global's users decide what a trace through the global reaches, so the
+// global is identified by the functions using it
+static uint64_t hashGlobalUsers(const GlobalVariable &GV, const StringMap<uint64_t> &functionHashes) {
+    std::vector<std::string> users;
+    for (const User *U : GV.users()) {
+        if (auto *I = dyn_cast<Instruction>(U)) {
+            StringRef name = I->getFunction()->getName();
+            users.push_back(name.str() + ":" + utohexstr(functionHashes.lookup(name)));
+        }
+    }
+    llvm::sort(users);
+    users.erase(std::unique(users.begin(), users.end()), users.end());
+    return xxHash64(join(users, ";"));
+}
+
+// Findings of one function as stored in the cache, along with what they were
+// computed from
+struct CacheEntry {
+    // A function (kind 'F') or global (kind 'G') and its hash
+    struct Dependency {
+        char kind;
+        std::string name;
+        uint64_t hash;
+    };
+
+    uint64_t hash = 0;  // hashFunction of the function itself
+    std::vector<Dependency> dependencies;
+    std::vector<BranchRecord> records;
+};
+
+// Bounds checked little-endian decoding of cache entries
+struct CacheReader {
+    StringRef data;
+    bool ok = true;
+
+    uint32_t u32() {
+        if (data.size() < 4) {
+            ok = false;
+            return 0;
+        }
+        uint32_t value = support::endian::read32le(data.data());
+        data = data.drop_front(4);
+        return value;
+    }
+
+    uint64_t u64() {
+        uint64_t low = u32();
+        return low | (uint64_t(u32()) << 32);
+    }
+
+    std::string str() {
+        uint32_t size = u32();
+        if (!ok || data.size() < size) {
+            ok = false;
+            return "";
+        }
+        std::string value = data.take_front(size).str();
+        data = data.drop_front(size);
+        return value;
+    }
+
+    SourceLocation loc() {
+        SourceLocation Loc;
+        Loc.file = str();
+        Loc.line = u32();
+        Loc.col = u32();
+        return Loc;
+    }
+};
+
+struct CacheWriter {
+    std::string &out;
+
+    void u32(uint32_t value) {
+        char bytes[4];
+        support::endian::write32le(bytes, value);
+        out.append(bytes, 4);
+    }
+
+    void u64(uint64_t value) {
+        u32(uint32_t(value));
+        u32(uint32_t(value >> 32));
+    }
+
+    void str(StringRef value) {
+        u32(value.size());
+        out.append(value.data(), value.size());
+    }
+
+    void loc(const SourceLocation &Loc) {
+        str(Loc.file);
+        u32(Loc.line);
+        u32(Loc.col);
+    }
+};
+
+// Append-only file of cached function findings, shared by all translation
+// units using the same cache directory. Each entry is a magic number, the
+// payload size and the payload, which starts with the entry's key. The file
+// is memory-mapped and only the keys are read up front; a later entry for the
+// same key replaces an earlier one.
+struct SeminalCache {
+    static constexpr uint32_t Magic = 0x33434d53;  // "SMC3"
+
+    std::string path;
+    std::unique_ptr<MemoryBuffer> buffer;
+    StringMap<StringRef> entries;
+    std::string pending;  // encoded entries to append
+
+    static std::string makeKey(StringRef module, StringRef function, uint64_t options) {
+        return (module + Twine('\0') + function + Twine('\0') + utohexstr(options)).str();
+    }
+
+    void load(StringRef dir) {
+        SmallString<128> file(dir);
+        sys::path::append(file, "seminal-cache.bin");
+        path = std::string(file);
+
+        ErrorOr<std::unique_ptr<MemoryBuffer>> mapped =
+            MemoryBuffer::getFile(path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+        if (!mapped) {
+            return;  // nothing cached yet
+        }
+        buffer = std::move(*mapped);
+
+        // A truncated entry at the end (an interrupted build) ends the scan
+        CacheReader reader{buffer->getBuffer()};
+        while (reader.data.size() >= 8) {
+            if (reader.u32() != Magic) {
+                break;
+            }
+            uint32_t size = reader.u32();
+            if (size > reader.data.size()) {
+                break;
+            }
+            StringRef payload = reader.data.take_front(size);
+            reader.data = reader.data.drop_front(size);
+
+            CacheReader keyReader{payload};
+            std::string key = keyReader.str();
+            if (keyReader.ok) {
+                entries[key] = payload;
+            }
+        }
+    }
+
+    bool lookup(StringRef key, CacheEntry &entry) const {
+        auto It = entries.find(key);
+        if (It == entries.end()) {
+            return false;
+        }
+
+        CacheReader reader{It->second};
+        reader.str();
+        entry.hash = reader.u64();
+        for (uint32_t n = reader.u32(); reader.ok && n > 0; n--) {
+            CacheEntry::Dependency dep;
+            dep.kind = char(reader.u32());
+            dep.name = reader.str();
+            dep.hash = reader.u64();
+            entry.dependencies.push_back(std::move(dep));
+        }
+        for (uint32_t n = reader.u32(); reader.ok && n > 0; n--) {
+            BranchRecord record;
+            record.function = reader.str();
+            record.loc = reader.loc();
+            record.kind = reader.str();
+            for (uint32_t m = reader.u32(); reader.ok && m > 0; m--) {
+                SourceRecord source;
+                source.callee = reader.str();
+                source.function = reader.str();
+                source.loc = reader.loc();
+                record.sources.push_back(std::move(source));
+            }
+            for (uint32_t m = reader.u32(); reader.ok && m > 0; m--) {
+                record.externalCalls.push_back(reader.str());
+            }
+            entry.records.push_back(std::move(record));
+        }
+        return reader.ok;
+    }
+
+    void add(StringRef key, const CacheEntry &entry) {
+        std::string payload;
+        CacheWriter writer{payload};
+        writer.str(key);
+        writer.u64(entry.hash);
+        writer.u32(entry.dependencies.size());
+        for (const CacheEntry::Dependency &dep : entry.dependencies) {
+            writer.u32(dep.kind);
+            writer.str(dep.name);
+            writer.u64(dep.hash);
+        }
+        writer.u32(entry.records.size());
+        for (const BranchRecord &record : entry.records) {
+            writer.str(record.function);
+            writer.loc(record.loc);
+            writer.str(record.kind);
+            writer.u32(record.sources.size());
+            for (const SourceRecord &source : record.sources) {
+                writer.str(source.callee);
+                writer.str(source.function);
+                writer.loc(source.loc);
+            }
+            writer.u32(record.externalCalls.size());
+            for (const std::string &callee : record.externalCalls) {
+                writer.str(callee);
+            }
+        }
+
+        CacheWriter header{pending};
+        header.u32(Magic);
+        header.u32(payload.size());
+        pending += payload;
+    }
+
+    // Append the new entries with a single write, so that concurrent builds
+    // sharing the cache do not interleave their entries
+    void flush() {
+        if (pending.empty()) {
+            return;
+        }
+        if (std::error_code EC = sys::fs::create_directories(sys::path::parent_path(path))) {
+            errs() << "error: cannot create seminal input cache directory: " << EC.message() << "\n";
+            return;
+        }
+        std::error_code EC;
+        raw_fd_ostream OS(path, EC, sys::fs::OF_Append);
+        if (EC) {
+            errs() << "error: cannot open seminal input cache '" << path << "': " << EC.message() << "\n";
+            return;
+        }
+        OS.SetUnbuffered();
+        OS << pending;
+        pending.clear();
+    }
+};
+
+// What a call to a function yields, for the link step: its seminal inputs and
+// the external calls reaching its return value or pointer arguments
+struct FunctionRecord {
+    std::string name;
+    std::vector<SourceRecord> sources;
+    std::vector<std::string> externalCalls;
+};
+
+// Summaries of the functions other modules can call, leaving out those that
+// yield nothing
+static std::vector<FunctionRecord> exportSummaries(Module &M, const ModuleInfo &moduleInfo) {
+    std::vector<FunctionRecord> exported;
+    for (Function &F : M) {
+        const FunctionSummary *summary = moduleInfo.lookupSummary(&F);
+        if (!summary || F.hasLocalLinkage() || summary->callSources.empty()) {
+            continue;
+        }
+        FunctionRecord &record = exported.emplace_back();
+        record.name = F.getName().str();
+        SmallVector<CallInst*, 4> externalCalls;
+        for (CallInst *call : summary->callSources) {
+            if (moduleInfo.isExternalCall(call->getCalledFunction())) {
+                externalCalls.push_back(call);
+            } else {
+                record.sources.push_back(makeSourceRecord(call));
+            }
+        }
+        record.externalCalls = getExternalCallees(externalCalls);
+    }
+    return exported;
+}
+
+// Path of a per-module output file in dir, named after the source file of
+// the module and a hash of its path, so all files of a build can share dir
+static SmallString<128> getModuleFilePath(StringRef dir, const Module &M, StringRef extension) {
+    SmallString<128> path(dir);
+    sys::path::append(path, sys::path::stem(M.getSourceFileName()) + "-" +
+                            utohexstr(xxHash64(M.getSourceFileName())) + extension);
+    return path;
+}
+
+// Link summary of a module, read by link/seminal_link.py:
+//
+//   u32 magic "SMS2", module name,
+//   u32 number of branches, each: function, location, kind, u32 truncated,
+//       sources, external callees,
+//   u32 number of exported functions, each: name, sources, external callees
+//
+// with the CacheWriter encodings: strings are a u32 size and the bytes,
+// locations a file string, u32 line and u32 column, lists a u32 count.
+// Sources are callee, function and location; external callees are strings.
+static void writeLinkSummary(Module &M, ArrayRef<SeminalReport> reports, ArrayRef<FunctionRecord> exported) {
+    std::string out;
+    CacheWriter writer{out};
+    auto writeSources = [&](ArrayRef<SourceRecord> sources, ArrayRef<std::string> externalCalls) {
+        writer.u32(sources.size());
+        for (const SourceRecord &source : sources) {
+            writer.str(source.callee);
+            writer.str(source.function);
+            writer.loc(source.loc);
+        }
+        writer.u32(externalCalls.size());
+        for (const std::string &callee : externalCalls) {
+            writer.str(callee);
+        }
+    };
+
+    // The text format keeps no records, they are made from the findings
+    std::vector<BranchRecord> records;
+    for (const SeminalReport &report : reports) {
+        if (report.records.empty()) {
+            for (const BranchFinding &finding : report.branches) {
+                records.push_back(makeBranchRecord(finding));
+            }
+        } else {
+            records.insert(records.end(), report.records.begin(), report.records.end());
+        }
+    }
+
+    writer.u32(0x32534d53);  // "SMS2"
+    writer.str(M.getSourceFileName());
+    writer.u32(records.size());
+    for (const BranchRecord &record : records) {
+        writer.str(record.function);
+        writer.loc(record.loc);
+        writer.str(record.kind);
+        writer.u32(record.truncated);
+        writeSources(record.sources, record.externalCalls);
+    }
+    writer.u32(exported.size());
+    for (const FunctionRecord &record : exported) {
+        writer.str(record.name);
+        writeSources(record.sources, record.externalCalls);
+    }
+
+    if (std::error_code EC = sys::fs::create_directories(SummaryDir)) {
+        errs() << "error: cannot create seminal summary directory: " << EC.message() << "\n";
+        return;
+    }
+    SmallString<128> path = getModuleFilePath(SummaryDir, M, ".sms");
+    std::error_code EC;
+    raw_fd_ostream OS(path, EC);
+    if (EC) {
+        errs() << "error: cannot open seminal summary '" << path << "': " << EC.message() << "\n";
+        return;
+    }
+    OS << out;
+}
+
+// Quote a token of a fuzzing dictionary, escaping all but printable ASCII
+static void writeDictionaryToken(raw_ostream &OS, StringRef token) {
+    OS << '"';
+    for (unsigned char c : token) {
+        if (c == '"' || c == '\\' || !isPrint(c)) {
+            OS << "\\x" << hexdigit(c >> 4, /*LowerCase=*/true) << hexdigit(c & 15, /*LowerCase=*/true);
+        } else {
+            OS << c;
+        }
+    }
+    OS << '"';
+}
+
+// With -seminal-fuzz-dir, write for AFL++ (-x) and libFuzzer (-dict=) a
+// dictionary of the tokens the seminal-dependent branches compare against,
+// and a CSV of these branches, most dependent first. The weight of a branch
+// is the number of seminal input arguments feeding it, counting the calls
+// whose argument is unknown once; inputs are callee@file:line:column#arg.
+static void writeFuzzFiles(const Module &M, ArrayRef<SeminalReport> reports) {
+    std::vector<std::string> tokens;
+    StringSet<> seen;
+    std::vector<std::pair<unsigned, const BranchRecord*>> branches;  // id, record
+    unsigned id = 0;
+    for (const SeminalReport &report : reports) {
+        for (const BranchRecord &branch : report.records) {
+            unsigned branchId = branch.id.value_or(id);
+            id++;
+            if (branch.sources.empty()) {
+                continue;
+            }
+            branches.push_back({branchId, &branch});
+            for (const std::string &token : branch.tokens) {
+                if (seen.insert(token).second) {
+                    tokens.push_back(token);
+                }
+            }
+        }
+    }
+    auto weightOf = [](const BranchRecord &branch) {
+        unsigned weight = 0;
+        for (const SourceRecord &source : branch.sources) {
+            weight += std::max<size_t>(source.arguments.size(), 1);
+        }
+        return weight;
+    };
+    llvm::stable_sort(branches, [&](const auto &a, const auto &b) {
+        return weightOf(*a.second) > weightOf(*b.second);
+    });
+
+    if (std::error_code EC = sys::fs::create_directories(FuzzDir)) {
+        errs() << "error: cannot create seminal fuzz directory: " << EC.message() << "\n";
+        return;
+    }
+    SmallString<128> dictPath = getModuleFilePath(FuzzDir, M, ".dict");
+    SmallString<128> priorityPath = getModuleFilePath(FuzzDir, M, ".priority");
+    std::error_code EC;
+    raw_fd_ostream dict(dictPath, EC);
+    if (EC) {
+        errs() << "error: cannot open fuzzing dictionary '" << dictPath << "': " << EC.message() << "\n";
+        return;
+    }
+    raw_fd_ostream priority(priorityPath, EC);
+    if (EC) {
+        errs() << "error: cannot open branch priorities '" << priorityPath << "': " << EC.message() << "\n";
+        return;
+    }
+
+    dict << "# Tokens compared against seminal inputs in " << M.getSourceFileName() << "\n";
+    for (size_t i = 0; i < tokens.size(); i++) {
+        dict << "seminal_" << i << "=";
+        writeDictionaryToken(dict, tokens[i]);
+        dict << "\n";
+    }
+
+    priority << "branch_id,weight,function,file,line,column,kind,inputs\n";
+    for (const auto &[branchId, branch] : branches) {
+        priority << branchId << "," << weightOf(*branch) << ",";
+        writeCSVField(priority, branch->function);
+        priority << ",";
+        writeCSVField(priority, branch->loc.file);
+        priority << "," << branch->loc.line << "," << branch->loc.col << "," << branch->kind << ",";
+        std::string inputs;
+        for (const SourceRecord &source : branch->sources) {
+            std::string where = source.callee + "@" + source.loc.file + ":" + utostr(source.loc.line) + ":" +
+                                utostr(source.loc.col);
+            if (source.arguments.empty()) {
+                inputs += (inputs.empty() ? "" : ";") + where;
+            }
+            for (int arg : source.arguments) {
+                inputs += (inputs.empty() ? "" : ";") + where + "#" + (arg < 0 ? "ret" : std::to_string(arg));
+            }
+        }
+        writeCSVField(priority, inputs);
+        priority << "\n";
+    }
+}
+
+static std::vector<Function*> getDefinedFunctions(Module &M) {
+    std::vector<Function*> functions;
+    for (auto &F : M) {
+        if (!F.isDeclaration()) {
+            functions.push_back(&F);
+        }
+    }
+    return functions;
+}
+
+// Fill in the analyses of the module the tracers need besides the index
+// built by ModuleInfo, ending the "index" and "summaries" phases
+static void prepareModuleInfo(Module &M, ModuleAnalysisManager &AM, ModuleInfo &moduleInfo, PhaseStatistics &stats) {
+    if (MemorySSAMode) {
+        // Computed up front, the analysis manager is not thread safe
+        FunctionAnalysisManager &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+        for (Function *F : getDefinedFunctions(M)) {
+            moduleInfo.memorySSA[F] = &FAM.getResult<MemorySSAAnalysis>(*F).getMSSA();
+        }
+    }
+    stats.endPhase("index");
+    // A query traces only a few branches, which would not pay for walking
+    // every global of the module up front
+    bool globalSummaries = !MemorySSAMode && ReportFormatOpt != ReportFormat::Text && !BranchQuery::isRequested();
+    if (useInterprocedural() || globalSummaries) {
+        size_t visitedValues = 0;
+        if (useInterprocedural()) {
+            visitedValues += computeSummaries(M, moduleInfo);
+        }
+        if (globalSummaries) {
+            visitedValues += computeGlobalSummaries(M, moduleInfo);
+        }
+        stats.endPhase("summaries", visitedValues);
+    }
+}
+
+// Each function is traced with its own tracer state and report, on the
+// thread pool with -seminal-parallel. The reports are in the order of
+// functions, so the merged result does not depend on scheduling.
+static std::vector<SeminalReport> traceFunctions(ArrayRef<Function*> functions, const ModuleInfo &moduleInfo, bool verbose) {
+    std::vector<SeminalReport> reports(functions.size());
+    auto traceOne = [&](size_t i) {
+        traceInto(reports[i], functions[i], moduleInfo, verbose);
+    };
+
+    if (!ParallelAnalysis) {
+        for (size_t i = 0; i < functions.size(); i++) {
+            traceOne(i);
+        }
+        return reports;
+    }
+
+    ThreadPool pool(hardware_concurrency(AnalysisThreads));
+    for (size_t i = 0; i < functions.size(); i++) {
+        pool.async([&traceOne, i] { traceOne(i); });
+    }
+    pool.wait();
+    return reports;
+}
+
+static size_t countVisitedValues(ArrayRef<SeminalReport> reports) {
+    size_t visitedValues = 0;
+    for (const SeminalReport &report : reports) {
+        visitedValues += report.visitedValues;
+    }
+    return visitedValues;
+}
+
+}
+
+struct seminal::SeminalInputInfo::Details {
+    std::vector<SeminalReport> reports;
+    PhaseStatistics stats;  // of the computation of the result
+    std::vector<FunctionRecord> exported;  // with -seminal-summary-dir
+};
+
+SeminalInputInfo::SeminalInputInfo() : D(std::make_unique<Details>()) {}
+SeminalInputInfo::SeminalInputInfo(SeminalInputInfo &&) = default;
+SeminalInputInfo &SeminalInputInfo::operator=(SeminalInputInfo &&) = default;
+SeminalInputInfo::~SeminalInputInfo() = default;
+
+void SeminalInputInfo::buildIndex() {
+    allFindings.clear();
+    findingOf.clear();
+    for (const SeminalReport &report : D->reports) {
+        for (const BranchFinding &finding : report.branches) {
+            allFindings.push_back(&finding);
+            findingOf[finding.Br] = &finding;
+        }
+    }
+}
+
+SeminalInputInfo SeminalInputAnalysis::run(Module &M, ModuleAnalysisManager &AM) {
+    Result Info;
+    SeminalInputInfo::Details &D = Info.details();
+    ModuleInfo moduleInfo(M);
+    prepareModuleInfo(M, AM, moduleInfo, D.stats);
+
+    bool verbose = ReportFormatOpt == ReportFormat::Text;
+    if (ParallelAnalysis) {
+        D.reports = traceFunctions(getDefinedFunctions(M), moduleInfo, verbose);
+    } else {
+        traceInto(D.reports.emplace_back(), getDefinedFunctions(M), moduleInfo, verbose);
+    }
+    D.stats.endPhase("trace", countVisitedValues(D.reports));
+    if (!SummaryDir.empty()) {
+        D.exported = exportSummaries(M, moduleInfo);
+    }
+    Info.buildIndex();
+    return Info;
+}
+
+AnalysisKey SeminalInputAnalysis::Key;
+
+namespace {
+
+// Prints the findings of SeminalInputAnalysis in the selected report format
+struct SkeletonPass : public PassInfoMixin<SkeletonPass> {
+    raw_ostream *Out = nullptr;  // instead of -seminal-report-file or stderr
+
+    PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM) {
+        // Checked before the trace; a binary image on stderr is of no use
+        if (!Out && ReportFormatOpt == ReportFormat::Binary && ReportFile.empty()) {
+            M.getContext().emitError("-seminal-report-format=binary needs -seminal-report-file");
+            return PreservedAnalyses::all();
+        }
+
+        // The cache only keeps the structured findings, so it bypasses the
+        // analysis and only traces the functions that changed. A query only
+        // traces some branches, and the fuzzing files need the IR of every
+        // branch, so neither uses the cache.
+        if (!CacheDir.empty() && ReportFormatOpt != ReportFormat::Text && !BranchQuery::isRequested() &&
+            FuzzDir.empty()) {
+            PhaseStatistics stats;
+            ModuleInfo moduleInfo(M);
+            prepareModuleInfo(M, AM, moduleInfo, stats);
+            std::vector<SeminalReport> reports = runCached(M, moduleInfo);
+            stats.endPhase("trace", countVisitedValues(reports));
+            std::vector<FunctionRecord> exported;
+            if (!SummaryDir.empty()) {
+                exported = exportSummaries(M, moduleInfo);
+            }
+            printReports(M, reports, exported, stats);
+            return PreservedAnalyses::all();
+        }
+
+        const SeminalInputInfo &Info = AM.getResult<SeminalInputAnalysis>(M);
+        PhaseStatistics stats = Info.details().stats;
+        stats.startPhase();
+        printReports(M, Info.details().reports, Info.details().exported, stats);
+        return PreservedAnalyses::all();
+    };
+
+    void printReports(Module &M, ArrayRef<SeminalReport> reports, ArrayRef<FunctionRecord> exported,
+                      PhaseStatistics &stats) {
+        if (Out) {
+            writeReports(*Out, M, reports);
+        } else {
+            writeReports(M, reports);
+        }
+        if (!SummaryDir.empty()) {
+            writeLinkSummary(M, reports, exported);
+        }
+        if (!FuzzDir.empty()) {
+            writeFuzzFiles(M, reports);
+        }
+        stats.endPhase("report");
+        if (PhaseStats) {
+            stats.print(M);
+        }
+    }
+
+    // Replay the cached findings of functions that are unchanged since they
+    // were cached, along with the functions and globals their trace walked
+    // through. Only the other functions are traced, and their findings added
+    // to the cache.
+    std::vector<SeminalReport> runCached(Module &M, const ModuleInfo &moduleInfo) {
+        std::vector<Function*> functions = getDefinedFunctions(M);
+        StringMap<uint64_t> hashes;
+        for (Function *F : functions) {
+            hashes[F->getName()] = hashFunction(*F);
+        }
+
+        auto isUpToDate = [&](const CacheEntry &entry, Function *F) {
+            if (entry.hash != hashes.lookup(F->getName())) {
+                return false;
+            }
+            for (const CacheEntry::Dependency &dep : entry.dependencies) {
+                if (dep.kind == 'F') {
+                    auto It = hashes.find(dep.name);
+                    if (It == hashes.end() || It->second != dep.hash) {
+                        return false;
+                    }
+                } else {
+                    GlobalVariable *GV = M.getGlobalVariable(dep.name, /*AllowInternal=*/true);
+                    if (!GV || hashGlobalUsers(*GV, hashes) != dep.hash) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        };
+
+        SeminalCache cache;
+        cache.load(CacheDir);
+        // Every option that changes what a trace finds is part of the key
+        std::string tracing;
+        raw_string_ostream OS(tracing);
+        OS << "ssa=" << SSAMode << " memoryssa=" << MemorySSAMode << " field=" << FieldSensitive
+           << " dataflow=" << (DataflowMode || CondenseMode) << " link=" << !SummaryDir.empty()
+           << " control-flow=" << ControlFlowKinds.getBits() << " depth=" << MaxTraceDepth
+           << " branch-values=" << MaxBranchValues << " function-values=" << MaxFunctionValues
+           << " function-ms=" << MaxFunctionTime;
+        uint64_t options = moduleInfo.sources.hash() ^ xxHash64(OS.str());
+        // Summaries carry findings across functions without recording which
+        // ones, so with them any change in the module invalidates the cache
+        if (useInterprocedural()) {
+            std::string moduleHash = "ipa";
+            for (Function *F : functions) {
+                moduleHash += ":" + utohexstr(hashes.lookup(F->getName()));
+            }
+            options ^= xxHash64(moduleHash);
+        }
+
+        std::vector<SeminalReport> reports(functions.size());
+        std::vector<Function*> stale;
+        std::vector<size_t> staleIndex;
+        for (size_t i = 0; i < functions.size(); i++) {
+            CacheEntry entry;
+            std::string key = SeminalCache::makeKey(M.getSourceFileName(), functions[i]->getName(), options);
+            if (cache.lookup(key, entry) && isUpToDate(entry, functions[i])) {
+                reports[i].records = std::move(entry.records);
+                ++NumCachedFunctions;
+            } else {
+                stale.push_back(functions[i]);
+                staleIndex.push_back(i);
+            }
+        }
+
+        std::vector<SeminalReport> traced = traceFunctions(stale, moduleInfo, /*verbose=*/false);
+        for (size_t j = 0; j < stale.size(); j++) {
+            Function *F = stale[j];
+            SeminalReport &report = traced[j];
+
+            // Truncated findings depend on the budgets and, with a time budget,
+            // on the machine, so the function is traced again next time
+            bool truncated = any_of(report.records, [](const BranchRecord &record) { return record.truncated; });
+            if (truncated) {
+                reports[staleIndex[j]] = std::move(report);
+                continue;
+            }
+
+            CacheEntry entry;
+            entry.hash = hashes.lookup(F->getName());
+            for (const Function *dep : report.visitedFunctions) {
+                if (dep != F) {
+                    entry.dependencies.push_back({'F', dep->getName().str(), hashes.lookup(dep->getName())});
+                }
+            }
+            for (const GlobalVariable *GV : report.visitedGlobals) {
+                entry.dependencies.push_back({'G', GV->getName().str(), hashGlobalUsers(*GV, hashes)});
+            }
+            entry.records = report.records;
+            cache.add(SeminalCache::makeKey(M.getSourceFileName(), F->getName(), options), entry);
+
+            reports[staleIndex[j]] = std::move(report);
+        }
+        cache.flush();
+        return reports;
+    }
+};
+
+
+static cl::opt<bool> InstrumentBranches("seminal-instrument",
+    cl::desc("Count the executions of the branches reached by seminal inputs"),
+    cl::init(false));
+
+static cl::opt<std::string> ProfileFile("seminal-profile-file",
+    cl::desc("Profile file of instrumented programs, overridden at run time by SEMINAL_PROFILE"),
+    cl::value_desc("filename"), cl::init("seminal.prof"));
+
+// Adds a pair of counters, condition true and condition false, to every
+// conditional branch, and scalar select with -seminal-control-flow=select,
+// reached by a seminal input. At exit the program appends a
+// record to the profile file: this header followed by the counters.
+//
+//   u32 magic "SMP1", u32 size and bytes of the module name,
+//   u32 number of branches N, u32 size and bytes of the branch table,
+//   N pairs of u64 counters
+//
+// The branch table has one "function\tfile\tline\tcolumn\n" line per branch.
+// Integers are little-endian. The counters are relaxed atomic adds on one
+// array per module, so threads need no registration or merging at exit.
+struct SeminalInstrumentPass : public PassInfoMixin<SeminalInstrumentPass> {
+    static constexpr uint32_t Magic = 0x31504d53;  // "SMP1"
+
+    PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM) {
+        const SeminalInputInfo &Info = AM.getResult<SeminalInputAnalysis>(M);
+        // Switches and indirect branches have no true and false to count
+        std::vector<Instruction*> branches;
+        std::vector<Value*> conditions;
+        std::string table;
+        for (const BranchFinding *finding : Info.findings()) {
+            Value *condition = getDecidingValue(*finding->Br);
+            bool twoWay = isa<BranchInst>(finding->Br) ||
+                          (isa<SelectInst>(finding->Br) && condition->getType()->isIntegerTy(1));
+            if (finding->Sources.empty() || !twoWay) {
+                continue;
+            }
+            BranchRecord record = makeBranchRecord(*finding);
+            branches.push_back(finding->Br);
+            conditions.push_back(condition);
+            table += record.function + "\t" + record.loc.file + "\t" + utostr(record.loc.line) + "\t" +
+                     utostr(record.loc.col) + "\n";
+        }
+        if (branches.empty()) {
+            return PreservedAnalyses::all();
+        }
+
+        LLVMContext &C = M.getContext();
+        ArrayType *countersTy = ArrayType::get(Type::getInt64Ty(C), 2 * branches.size());
+        auto *counters = new GlobalVariable(M, countersTy, /*isConstant=*/false, GlobalValue::PrivateLinkage,
+                                            Constant::getNullValue(countersTy), "__seminal_counters");
+        for (size_t i = 0; i < branches.size(); i++) {
+            IRBuilder<> B(branches[i]);
+            Value *index = B.CreateSelect(conditions[i], B.getInt64(2 * i), B.getInt64(2 * i + 1));
+            Value *counter = B.CreateInBoundsGEP(countersTy, counters, {B.getInt64(0), index});
+            B.CreateAtomicRMW(AtomicRMWInst::Add, counter, B.getInt64(1), MaybeAlign(8), AtomicOrdering::Monotonic);
+        }
+
+        std::string header;
+        CacheWriter writer{header};
+        writer.u32(Magic);
+        writer.str(M.getSourceFileName());
+        writer.u32(branches.size());
+        writer.str(table);
+        emitFlush(M, counters, header);
+
+        // The functions traced gain instructions but no blocks; the
+        // findings are stale
+        PreservedAnalyses PA;
+        PA.preserveSet<CFGAnalyses>();
+        PA.preserve<FunctionAnalysisManagerModuleProxy>();
+        return PA;
+    }
+
+    // Register a function writing the header and the counters at exit
+    void emitFlush(Module &M, GlobalVariable *counters, StringRef header) {
+        LLVMContext &C = M.getContext();
+        auto *headerInit = ConstantDataArray::getString(C, header, /*AddNull=*/false);
+        auto *headerVar = new GlobalVariable(M, headerInit->getType(), /*isConstant=*/true,
+                                             GlobalValue::PrivateLinkage, headerInit, "__seminal_profile_header");
+
+        Type *voidTy = Type::getVoidTy(C);
+        Type *int8PtrTy = Type::getInt8PtrTy(C);
+        Type *sizeTy = M.getDataLayout().getIntPtrType(C);
+        FunctionType *handlerTy = FunctionType::get(voidTy, false);
+        FunctionCallee getenvFn = M.getOrInsertFunction("getenv", int8PtrTy, int8PtrTy);
+        FunctionCallee fopenFn = M.getOrInsertFunction("fopen", int8PtrTy, int8PtrTy, int8PtrTy);
+        FunctionCallee fwriteFn = M.getOrInsertFunction("fwrite", sizeTy, int8PtrTy, sizeTy, sizeTy, int8PtrTy);
+        FunctionCallee fcloseFn = M.getOrInsertFunction("fclose", Type::getInt32Ty(C), int8PtrTy);
+        FunctionCallee atexitFn = M.getOrInsertFunction("atexit", Type::getInt32Ty(C), handlerTy->getPointerTo());
+
+        Function *flush = Function::Create(handlerTy, GlobalValue::InternalLinkage, "__seminal_flush", M);
+        BasicBlock *entry = BasicBlock::Create(C, "entry", flush);
+        BasicBlock *write = BasicBlock::Create(C, "write", flush);
+        BasicBlock *done = BasicBlock::Create(C, "done", flush);
+
+        IRBuilder<> B(entry);
+        Value *env = B.CreateCall(getenvFn, {B.CreateGlobalStringPtr("SEMINAL_PROFILE")});
+        Value *path = B.CreateSelect(B.CreateIsNull(env), B.CreateGlobalStringPtr(ProfileFile), env);
+        Value *file = B.CreateCall(fopenFn, {path, B.CreateGlobalStringPtr("ab")});
+        B.CreateCondBr(B.CreateIsNull(file), done, write);
+
+        B.SetInsertPoint(write);
+        uint64_t numCounters = counters->getValueType()->getArrayNumElements();
+        B.CreateCall(fwriteFn, {B.CreatePointerCast(headerVar, int8PtrTy), ConstantInt::get(sizeTy, 1),
+                                ConstantInt::get(sizeTy, header.size()), file});
+        B.CreateCall(fwriteFn, {B.CreatePointerCast(counters, int8PtrTy), ConstantInt::get(sizeTy, 8),
+                                ConstantInt::get(sizeTy, numCounters), file});
+        B.CreateCall(fcloseFn, {file});
+        B.CreateBr(done);
+
+        B.SetInsertPoint(done);
+        B.CreateRetVoid();
+
+        Function *ctor = Function::Create(handlerTy, GlobalValue::InternalLinkage, "__seminal_register", M);
+        B.SetInsertPoint(BasicBlock::Create(C, "entry", ctor));
+        B.CreateCall(atexitFn, {flush});
+        B.CreateRetVoid();
+        // The default priority; 0 to 100 are reserved for the implementation.
+        // Handlers the program registers later still run before the flush.
+        appendToGlobalCtors(M, ctor, /*Priority=*/65535);
+    }
+};
+
+}
+
+bool seminal::isBinaryReport() {
+    return ReportFormatOpt == ReportFormat::Binary;
+}
+
+// Entry point of the seminal-analyze tool. The functions of a lazily loaded
+// module are materialized, traced and deleted one at a time, so memory is
+// bounded by the largest function; globals are only followed into the
+// function being traced. With wholeModule, and for interprocedural summaries
+// and the cache, the module is materialized up front and run as by the plugin.
+bool seminal::analyzeModule(Module &M, raw_ostream &OS, bool wholeModule) {
+    LoopAnalysisManager LAM;
+    FunctionAnalysisManager FAM;
+    CGSCCAnalysisManager CGAM;
+    ModuleAnalysisManager MAM;
+    PassBuilder PB;
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+    MAM.registerPass([] { return SeminalInputAnalysis(); });
+
+    if (wholeModule || useInterprocedural() || !CacheDir.empty()) {
+        if (Error E = M.materializeAll()) {
+            errs() << "error: " << M.getModuleIdentifier() << ": " << toString(std::move(E)) << "\n";
+            return false;
+        }
+        SkeletonPass pass;
+        pass.Out = &OS;
+        pass.run(M, MAM);
+        return true;
+    }
+
+    PhaseStatistics stats;
+    ModuleInfo moduleInfo(M);
+    stats.endPhase("index");
+
+    bool verbose = ReportFormatOpt == ReportFormat::Text;
+    std::vector<SeminalReport> reports(1);
+    for (Function &F : M) {
+        if (F.isDeclaration()) {
+            continue;
+        }
+        // Bodies parsed with the module (.ll files) are already indexed
+        if (F.isMaterializable()) {
+            if (Error E = F.materialize()) {
+                errs() << "error: " << M.getModuleIdentifier() << ": " << toString(std::move(E)) << "\n";
+                return false;
+            }
+            moduleInfo.debugInfo.addFunction(F);
+            moduleInfo.query.addFunction(F);
+        }
+        if (MemorySSAMode && moduleInfo.query.selects(F)) {
+            moduleInfo.memorySSA[&F] = &FAM.getResult<MemorySSAAnalysis>(F).getMSSA();
+        }
+
+        Function *traced = &F;
+        traceInto(reports.front(), traced, moduleInfo, verbose);
+
+        // The findings point into the body, only the records are kept
+        reports.front().branches.clear();
+        moduleInfo.memorySSA.erase(&F);
+        FAM.clear(F, F.getName());
+        moduleInfo.debugInfo.removeFunction(F);
+        moduleInfo.query.removeFunction(F);
+        F.deleteBody();
+    }
+    stats.endPhase("trace", countVisitedValues(reports));
+
+    writeReports(OS, M, reports);
+    if (!FuzzDir.empty()) {
+        writeFuzzFiles(M, reports);
+    }
+    stats.endPhase("report");
+    if (PhaseStats) {
+        stats.print(M);
+    }
+    return true;
+}
+
+// Loading the plugin only registers the passes by name. They are added to the
+// default pipelines when an extension point is chosen, so a build that loads
+// the plugin without asking for a report is not slowed down.
+enum class ExtensionPoint { Auto, PipelineStart, EarlySimplification, OptimizerLast, None };
+
+static cl::opt<ExtensionPoint> ExtensionPointOpt("seminal-ep",
+    cl::desc("Where the pass is added to the default pipelines"),
+    cl::values(clEnumValN(ExtensionPoint::Auto, "auto",
+                          "pipeline-start, or early-simplification with -seminal-ssa"),
+               clEnumValN(ExtensionPoint::PipelineStart, "pipeline-start", "Before any optimization"),
+               clEnumValN(ExtensionPoint::EarlySimplification, "early-simplification",
+                          "After SROA and the early cleanups; at -O0 at the start, with no SROA"),
+               clEnumValN(ExtensionPoint::OptimizerLast, "optimizer-last",
+                          "At the end of the optimization pipeline, on the smallest IR"),
+               clEnumValN(ExtensionPoint::None, "none",
+                          "Only run when named in -passes, e.g. -passes=seminal-trace (default)")),
+    cl::init(ExtensionPoint::None));
+
+static ExtensionPoint getExtensionPoint() {
+    if (ExtensionPointOpt == ExtensionPoint::Auto) {
+        return SSAMode ? ExtensionPoint::EarlySimplification : ExtensionPoint::PipelineStart;
+    }
+    return ExtensionPointOpt;
+}
+
+static void addSeminalPasses(ModulePassManager &MPM) {
+    MPM.addPass(SkeletonPass());
+    if (InstrumentBranches) {
+        MPM.addPass(SeminalInstrumentPass());
+    }
+}
+
+extern "C" LLVM_ATTRIBUTE_WEAK ::llvm::PassPluginLibraryInfo
+llvmGetPassPluginInfo() {
+    return {
+        .APIVersion = LLVM_PLUGIN_API_VERSION,
+        .PluginName = "Skeleton pass",
+        .PluginVersion = "v0.1",
+        .RegisterPassBuilderCallbacks = [](PassBuilder &PB) {
+            PB.registerAnalysisRegistrationCallback(
+                [](ModuleAnalysisManager &MAM) {
+                    MAM.registerPass([] { return SeminalInputAnalysis(); });
+                });
+            // By name, for -passes and custom pipelines
+            PB.registerPipelineParsingCallback(
+                [](StringRef Name, ModulePassManager &MPM, ArrayRef<PassBuilder::PipelineElement>) {
+                    if (Name == "seminal-trace") {
+                        MPM.addPass(SkeletonPass());
+                    } else if (Name == "seminal-instrument") {
+                        MPM.addPass(SeminalInstrumentPass());
+                    } else if (Name == "require<seminal-input>") {
+                        MPM.addPass(RequireAnalysisPass<SeminalInputAnalysis, Module>());
+                    } else {
+                        return false;
+                    }
+                    return true;
+                });
+            // The options are parsed by the time the pipeline is built
+            PB.registerPipelineStartEPCallback(
+                [](ModulePassManager &MPM, OptimizationLevel Level) {
+                    if (getExtensionPoint() == ExtensionPoint::PipelineStart) {
+                        addSeminalPasses(MPM);
+                    }
+                });
+            // E.g. with -seminal-ssa, once SROA has promoted the locals to
+            // SSA values. The -O0 pipeline runs this point too, but has no
+            // SROA, so the locals are still in memory there.
+            PB.registerPipelineEarlySimplificationEPCallback(
+                [](ModulePassManager &MPM, OptimizationLevel Level) {
+                    if (getExtensionPoint() == ExtensionPoint::EarlySimplification) {
+                        addSeminalPasses(MPM);
+                    }
+                });
+            PB.registerOptimizerLastEPCallback(
+                [](ModulePassManager &MPM, OptimizationLevel Level) {
+                    if (getExtensionPoint() == ExtensionPoint::OptimizerLast) {
+                        addSeminalPasses(MPM);
+                    }
                 });
         }
     };
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+# Read the profiles written by programs built with -seminal-instrument.
+#
+# Every run of an instrumented program appends one record per module to the
+# profile file. The records of the same branch are summed over runs and the
+# branches are listed hottest first, with how often their condition was true
+# and false.
+
+import argparse
+import csv
+import struct
+import sys
+
+MAGIC = 0x31504D53  # "SMP1"
+
+
+def read_records(data):
+    offset = 0
+
+    def u32():
+        nonlocal offset
+        (value,) = struct.unpack_from("<I", data, offset)
+        offset += 4
+        return value
+
+    def string():
+        nonlocal offset
+        size = u32()
+        value = data[offset:offset + size].decode("utf-8", "replace")
+        offset += size
+        return value
+
+    while offset + 4 <= len(data):
+        if u32() != MAGIC:
+            raise ValueError(f"bad record at offset {offset - 4}")
+        module = string()
+        count = u32()
+        table = string().splitlines()
+        counters = struct.unpack_from(f"<{2 * count}Q", data, offset)
+        offset += 16 * count
+        if len(table) != count:
+            raise ValueError(f"branch table of {module} does not match its counters")
+        for i, line in enumerate(table):
+            function, file, line_no, column = line.split("\t")
+            yield (module, function, file, int(line_no), int(column), i), counters[2 * i], counters[2 * i + 1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("profiles", nargs="+", help="profile files")
+    parser.add_argument("--top", type=int, default=0, help="only list the N hottest branches")
+    parser.add_argument("--csv", action="store_true", help="write CSV instead of a table")
+    args = parser.parse_args()
+
+    totals = {}
+    for path in args.profiles:
+        with open(path, "rb") as f:
+            data = f.read()
+        try:
+            for key, taken, not_taken in read_records(data):
+                previous = totals.get(key, (0, 0))
+                totals[key] = (previous[0] + taken, previous[1] + not_taken)
+        except (ValueError, struct.error) as error:
+            sys.exit(f"error: {path}: {error}")
+
+    # The branch index only tells apart branches without a debug location
+    rows = sorted(totals.items(), key=lambda item: (-sum(item[1]), item[0]))
+    if args.top:
+        rows = rows[:args.top]
+
+    if args.csv:
+        writer = csv.writer(sys.stdout)
+        writer.writerow(["module", "function", "file", "line", "column", "true", "false"])
+        for (module, function, file, line, column, _), (taken, not_taken) in rows:
+            writer.writerow([module, function, file, line, column, taken, not_taken])
+        return
+
+    print(f"{'executions':>12} {'true':>12} {'false':>12}  branch")
+    for (module, function, file, line, column, index), (taken, not_taken) in rows:
+        where = f"{file}:{line}:{column}" if line else f"{module} branch #{index}"
+        print(f"{taken + not_taken:>12} {taken:>12} {not_taken:>12}  {function} at {where}")
+
+
+if __name__ == "__main__":
+    main()
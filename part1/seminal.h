@@ -0,0 +1,21 @@
+#ifndef SEMINAL_H
+#define SEMINAL_H
+
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace seminal {
+
+// Trace the conditional branches of a module, which may be lazily loaded, and
+// write the report in the format selected by -seminal-report-format to OS.
+// Functions are materialized one at a time unless wholeModule is set.
+// Returns false if the module cannot be materialized.
+bool analyzeModule(llvm::Module &M, llvm::raw_ostream &OS, bool wholeModule);
+
+// Whether -seminal-report-format=binary is selected. A binary report holds a
+// single module, so reports of several modules cannot be concatenated.
+bool isBinaryReport();
+
+}
+
+#endif
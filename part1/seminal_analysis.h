@@ -0,0 +1,88 @@
+#ifndef SEMINAL_ANALYSIS_H
+#define SEMINAL_ANALYSIS_H
+
+#include <memory>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/PassManager.h"
+
+// The seminal input analysis as seen by other passes. Register it with
+//
+//   MAM.registerPass([] { return seminal::SeminalInputAnalysis(); });
+//
+// or load the plugin, which registers it, and ask the module analysis manager
+// for the findings:
+//
+//   const seminal::SeminalInputInfo &Info = MAM.getResult<seminal::SeminalInputAnalysis>(M);
+//   for (llvm::CallInst *source : Info.getSources(Br)) ...
+//
+// The analysis is configured by the -seminal-* options.
+
+namespace seminal {
+
+// Seminal inputs reaching one conditional branch, or one of the other
+// instructions selected by -seminal-control-flow
+struct BranchFinding {
+    llvm::Instruction *Br;
+    llvm::SmallVector<llvm::CallInst*, 4> Sources;
+    bool Truncated;  // an exploration budget ran out, Sources may be incomplete
+    llvm::SmallVector<llvm::CallInst*, 2> ExternalCalls;  // with -seminal-summary-dir
+};
+
+// Seminal inputs reaching the conditional branches of a module, the result of
+// SeminalInputAnalysis. The findings point into the IR, so the result is
+// invalidated along with any transformation that does not preserve it.
+class SeminalInputInfo {
+public:
+    SeminalInputInfo();
+    SeminalInputInfo(SeminalInputInfo &&);
+    SeminalInputInfo &operator=(SeminalInputInfo &&);
+    ~SeminalInputInfo();
+
+    // Every finding, in report order
+    llvm::ArrayRef<const BranchFinding*> findings() const { return allFindings; }
+
+    // The findings of a conditional branch or other traced instruction, or
+    // null if it was not traced
+    const BranchFinding *lookup(const llvm::Instruction *Br) const {
+        return findingOf.lookup(Br);
+    }
+
+    llvm::ArrayRef<llvm::CallInst*> getSources(const llvm::Instruction *Br) const {
+        const BranchFinding *finding = lookup(Br);
+        return finding ? llvm::ArrayRef<llvm::CallInst*>(finding->Sources) : llvm::ArrayRef<llvm::CallInst*>();
+    }
+
+    // The reports and statistics the plugin prints, defined in pass.cpp
+    struct Details;
+    Details &details() { return *D; }
+    const Details &details() const { return *D; }
+
+    void buildIndex();
+
+private:
+    std::unique_ptr<Details> D;
+    std::vector<const BranchFinding*> allFindings;
+    llvm::DenseMap<const llvm::Instruction*, const BranchFinding*> findingOf;
+};
+
+// Traces every conditional branch of the module back to its seminal inputs.
+// Passes that need the findings get them from the module analysis manager,
+// which keeps the result until the IR changes.
+class SeminalInputAnalysis : public llvm::AnalysisInfoMixin<SeminalInputAnalysis> {
+    friend llvm::AnalysisInfoMixin<SeminalInputAnalysis>;
+    static llvm::AnalysisKey Key;
+
+public:
+    using Result = SeminalInputInfo;
+
+    Result run(llvm::Module &M, llvm::ModuleAnalysisManager &AM);
+};
+
+}
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef SEMINAL_REPORT_H
+#define SEMINAL_REPORT_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Binary seminal input report, written with -seminal-report-format=binary,
+// and a reader that maps it into memory and queries it in place. The reader
+// only needs this header, not LLVM.
+//
+// A report holds one module. All fields are little-endian u32s:
+//
+//   Header
+//   Branch[numBranches]   in report order
+//   Source[numSources]    every seminal input call site once; in functions
+//                         replayed from -seminal-cache-dir, call sites
+//                         without debug info are told apart by callee and
+//                         function only
+//   u32[numEdges]         source indices; the sources of a branch are
+//                         edges[firstEdge, firstEdge + numEdges)
+//   char[stringsSize]     NUL-terminated strings; names and files are byte
+//                         offsets into this table, 0 is the empty string
+//
+// Hosts are assumed to be little-endian.
+
+namespace seminal {
+namespace report {
+
+constexpr uint32_t Magic = 0x31524d53;  // "SMR1"
+constexpr uint32_t Version = 1;
+
+enum Kind : uint32_t { KindBranch, KindSwitch, KindSelect, KindIndirectBr };
+
+enum Flags : uint32_t { FlagTruncated = 1 };
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t module;  // source file name of the module
+    uint32_t numBranches;
+    uint32_t numSources;
+    uint32_t numEdges;
+    uint32_t stringsSize;
+    uint32_t reserved;
+};
+
+struct Branch {
+    uint32_t id;  // as in the jsonl and csv reports
+    uint32_t function;
+    uint32_t file;
+    uint32_t line;  // 0 without debug info
+    uint32_t column;
+    uint32_t kind;
+    uint32_t flags;
+    uint32_t firstEdge;
+    uint32_t numEdges;
+};
+
+struct Source {
+    uint32_t callee;
+    uint32_t function;
+    uint32_t file;
+    uint32_t line;
+    uint32_t column;
+};
+
+static_assert(sizeof(Header) == 32 && sizeof(Branch) == 36 && sizeof(Source) == 20,
+              "report records must not be padded");
+
+inline const char *kindName(uint32_t kind) {
+    switch (kind) {
+    case KindSwitch:
+        return "switch";
+    case KindSelect:
+        return "select";
+    case KindIndirectBr:
+        return "indirectbr";
+    default:
+        return "branch";
+    }
+}
+
+// A read-only view of a report file. The file is checked once when opened,
+// then records and strings point straight into the mapping.
+class Reader {
+public:
+    Reader() = default;
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+    ~Reader() { close(); }
+
+    bool open(const char *path, std::string &error) {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            error = std::string("cannot open ") + path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            error = std::string(path) + ": empty or unreadable file";
+            return false;
+        }
+        void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            error = std::string("cannot map ") + path + ": " + std::strerror(errno);
+            return false;
+        }
+        mapping = data;
+        mappingSize = st.st_size;
+        if (!load(data, mappingSize, error)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // Use a report already in memory, which must outlive the reader and be
+    // aligned to 4 bytes
+    bool load(const void *data, size_t size, std::string &error) {
+        const char *bytes = static_cast<const char*>(data);
+        if (size < sizeof(Header)) {
+            error = "truncated report header";
+            return false;
+        }
+        const Header *h = reinterpret_cast<const Header*>(bytes);
+        if (h->magic != Magic || h->version != Version) {
+            error = "not a seminal report, or an unsupported version";
+            return false;
+        }
+        uint64_t branchesAt = sizeof(Header);
+        uint64_t sourcesAt = branchesAt + uint64_t(h->numBranches) * sizeof(Branch);
+        uint64_t edgesAt = sourcesAt + uint64_t(h->numSources) * sizeof(Source);
+        uint64_t stringsAt = edgesAt + uint64_t(h->numEdges) * sizeof(uint32_t);
+        if (stringsAt + h->stringsSize != size || h->stringsSize == 0 || bytes[size - 1] != '\0') {
+            error = "report sections do not match the file size";
+            return false;
+        }
+
+        header = h;
+        branchTable = reinterpret_cast<const Branch*>(bytes + branchesAt);
+        sourceTable = reinterpret_cast<const Source*>(bytes + sourcesAt);
+        edgeTable = reinterpret_cast<const uint32_t*>(bytes + edgesAt);
+        strings = bytes + stringsAt;
+
+        // Check every reference once, so lookups need no bounds checks
+        auto validString = [&](uint32_t offset) { return offset < h->stringsSize; };
+        bool ok = validString(h->module);
+        for (uint32_t i = 0; ok && i < h->numBranches; i++) {
+            const Branch &b = branchTable[i];
+            ok = validString(b.function) && validString(b.file) &&
+                 uint64_t(b.firstEdge) + b.numEdges <= h->numEdges;
+        }
+        for (uint32_t i = 0; ok && i < h->numSources; i++) {
+            const Source &s = sourceTable[i];
+            ok = validString(s.callee) && validString(s.function) && validString(s.file);
+        }
+        for (uint32_t i = 0; ok && i < h->numEdges; i++) {
+            ok = edgeTable[i] < h->numSources;
+        }
+        if (!ok) {
+            header = nullptr;
+            error = "report refers past the end of a table";
+        }
+        return ok;
+    }
+
+    void close() {
+        if (mapping) {
+            munmap(mapping, mappingSize);
+        }
+        mapping = nullptr;
+        mappingSize = 0;
+        header = nullptr;
+    }
+
+    std::string_view module() const { return string(header->module); }
+    uint32_t numBranches() const { return header->numBranches; }
+    uint32_t numSources() const { return header->numSources; }
+    const Branch &branch(uint32_t i) const { return branchTable[i]; }
+    const Source &source(uint32_t i) const { return sourceTable[i]; }
+
+    // The i-th seminal input reaching a branch, i < b.numEdges
+    const Source &source(const Branch &b, uint32_t i) const { return sourceTable[edgeTable[b.firstEdge + i]]; }
+
+    std::string_view string(uint32_t offset) const { return std::string_view(strings + offset); }
+
+private:
+    void *mapping = nullptr;
+    size_t mappingSize = 0;
+    const Header *header = nullptr;
+    const Branch *branchTable = nullptr;
+    const Source *sourceTable = nullptr;
+    const uint32_t *edgeTable = nullptr;
+    const char *strings = nullptr;
+};
+
+}
+}
+
+#endif